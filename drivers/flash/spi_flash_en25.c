@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "spi_flash_en25.h"
+
 #include <zephyr/drivers/flash.h>
 #include <zephyr/drivers/spi.h>
 #include <zephyr/kernel.h>
@@ -11,6 +13,32 @@
 #include <zephyr/pm/device.h>
 #include <zephyr/sys/byteorder.h>
 
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK) || IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD) ||  \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_BACKING_STORE)
+#include <zephyr/sys/atomic.h>
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DIGEST)
+#include <zephyr/sys/crc.h>
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE) ||                                                  \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE) ||                                   \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP) ||                                               \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_BACKING_STORE)
+#include <zephyr/spinlock.h>
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)
+#include <zephyr/sys/dlist.h>
+#endif
+#if IS_ENABLED(CONFIG_TINYCRYPT_SHA256)
+#include <tinycrypt/constants.h>
+#include <tinycrypt/sha256.h>
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BACKING_STORE)
+#include <mmu.h>
+#include <zephyr/sys/mem_manage.h>
+#endif
+
 #ifdef CONFIG_NRFX_SPIM_EXT_MUTEX
 #include <spi_external_mutex.h>
 #endif
@@ -64,31 +92,306 @@ LOG_MODULE_REGISTER(spi_flash_en25, CONFIG_FLASH_LOG_LEVEL);
 #define INST_HAS_HOLD_OR(inst)	DT_INST_NODE_HAS_PROP(inst, hold_gpios) ||
 #define ANY_INST_HAS_HOLD_GPIOS DT_INST_FOREACH_STATUS_OKAY(INST_HAS_HOLD_OR) 0
 
+#define HOLD_PREEMPT_ENABLED                                                                       \
+	(IS_ENABLED(CONFIG_SPI_FLASH_EN25_HOLD_PREEMPT) && (ANY_INST_HAS_HOLD_GPIOS))
+
+/* Features that read a region in chunks through driver owned buffers */
+#define STREAM_READ_ENABLED                                                                        \
+	(IS_ENABLED(CONFIG_SPI_FLASH_EN25_STREAM) || IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE) ||   \
+	 IS_ENABLED(CONFIG_SPI_FLASH_EN25_BULK_READ))
+
 #define INST_HAS_EXT_MUTEX_OR(inst)  DT_INST_NODE_HAS_PROP(inst, ext_mutex_gpios) ||
 #define ANY_INST_HAS_EXT_MUTEX_GPIOS DT_INST_FOREACH_STATUS_OKAY(INST_HAS_EXT_MUTEX_OR) 0
 
+#define INST_PROP_EQ_AND(inst, prop) (DT_INST_PROP(inst, prop) == DT_INST_PROP(0, prop)) &&
+#define ALL_INST_PROP_EQ(prop)                                                                     \
+	(DT_INST_FOREACH_STATUS_OKAY_VARGS(INST_PROP_EQ_AND, prop) 1)
+#define INST0_PROP_IS_POW2(prop)     IS_POWER_OF_TWO(DT_INST_PROP(0, prop))
+
+/*
+ * When every instance has the same power-of-two geometry, sizes are taken from the devicetree
+ * instead of the config struct. The compiler then folds them into the code and turns all
+ * divisions and remainders by them into shifts and masks.
+ */
+#define ALL_INST_SAME_GEOMETRY                                                                     \
+	(ALL_INST_PROP_EQ(size) && ALL_INST_PROP_EQ(write_sector_size) &&                          \
+	 ALL_INST_PROP_EQ(erase_full_block_size) && ALL_INST_PROP_EQ(erase_half_block_size) &&     \
+	 ALL_INST_PROP_EQ(erase_sector_size) && INST0_PROP_IS_POW2(size) &&                        \
+	 INST0_PROP_IS_POW2(write_sector_size) && INST0_PROP_IS_POW2(erase_full_block_size) &&     \
+	 INST0_PROP_IS_POW2(erase_half_block_size) && INST0_PROP_IS_POW2(erase_sector_size))
+
+#if ALL_INST_SAME_GEOMETRY
+#define CHIP_SIZE(cfg)		   ((void)(cfg), (uint32_t)(DT_INST_PROP(0, size) / 8))
+#define WRITE_SECTOR_SIZE(cfg)	   ((void)(cfg), (uint32_t)DT_INST_PROP(0, write_sector_size))
+#define ERASE_FULL_BLOCK_SIZE(cfg) ((void)(cfg), (uint32_t)DT_INST_PROP(0, erase_full_block_size))
+#define ERASE_HALF_BLOCK_SIZE(cfg) ((void)(cfg), (uint32_t)DT_INST_PROP(0, erase_half_block_size))
+#define ERASE_SECTOR_SIZE(cfg)	   ((void)(cfg), (uint32_t)DT_INST_PROP(0, erase_sector_size))
+#else
+#define CHIP_SIZE(cfg)		   ((cfg)->chip_size)
+#define WRITE_SECTOR_SIZE(cfg)	   ((cfg)->write_sector_size)
+#define ERASE_FULL_BLOCK_SIZE(cfg) ((cfg)->erase_full_block_size)
+#define ERASE_HALF_BLOCK_SIZE(cfg) ((cfg)->erase_half_block_size)
+#define ERASE_SECTOR_SIZE(cfg)	   ((cfg)->erase_sector_size)
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)
+/* Largest number of data buffers in a single read or page program */
+#define MAX_DATA_BUFS CONFIG_SPI_FLASH_EN25_IO_QUEUE_MAX_MERGE
+#else
+#define MAX_DATA_BUFS 1
+#endif
+
 #define STATUS_REG_WRITE_IN_PROGRESS 0x01
 
+/* Generous upper bound for a single page program, typical time is below 1 ms */
+#define PAGE_PROGRAM_TIMEOUT_US (10 * USEC_PER_MSEC)
+
 #define STATUS_REG_LSB_PAGE_SIZE_BIT 0x01
 
+/* Pausing a read more often than this costs more than reissuing the command */
+#define HOLD_MIN_BLOCK_LEN 16
+
 #define DEF_BUF_SET(_name, _buf_array)                                                             \
 	const struct spi_buf_set _name = {                                                         \
 		.buffers = _buf_array,                                                             \
 		.count = ARRAY_SIZE(_buf_array),                                                   \
 	}
 
+/* Commands that can use their own bus configuration */
+enum bus_profile {
+	BUS_READ,
+	BUS_PROGRAM,
+	BUS_STATUS,
+
+	BUS_PROFILE_COUNT,
+};
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)
+struct qos_class {
+	/* Budgets, 0 means unlimited */
+	uint32_t byte_rate;
+	uint32_t op_rate;
+	/* Token buckets, in thousandths of a byte or operation */
+	uint64_t byte_tokens;
+	uint64_t op_tokens;
+	int64_t last_refill;
+	struct spi_flash_en25_qos_stats stats;
+};
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP)
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP_COUNTER_8)
+typedef uint8_t heat_t;
+#elif IS_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP_COUNTER_32)
+typedef uint32_t heat_t;
+#else
+typedef uint16_t heat_t;
+#endif
+
+#define HEAT_MAX ((heat_t)~(heat_t)0)
+
+/* Saturating counters of one erase sector */
+struct heat_cell {
+	heat_t erases;
+	heat_t programs;
+	heat_t bytes;
+};
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BORROW)
+struct borrow_slot {
+	uint8_t buf[CONFIG_SPI_FLASH_EN25_BORROW_MAX_LEN] __aligned(sizeof(long));
+	off_t offset;
+	size_t len;
+	bool in_use;
+	/* Set when the borrowed region is written or erased */
+	bool stale;
+};
+#endif
+
 struct spi_flash_en25_data {
 	struct k_sem lock;
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BUS_PROFILES)
+	/* Copies of the bus spec with the frequency of each profile */
+	struct spi_dt_spec bus_profile[BUS_PROFILE_COUNT];
+#endif
+#if HOLD_PREEMPT_ENABLED
+	/* Read bus spec without chip select that keeps the bus locked between transfers */
+	struct spi_dt_spec bus_hold;
+	/* Bytes clocked between pauses, 0 when the instance cannot pause reads */
+	size_t hold_block_len;
+#endif
 #if IS_ENABLED(CONFIG_PM_DEVICE)
 	uint32_t pm_state;
 #endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_PREFETCH)
+	uint8_t prefetch_buf[CONFIG_SPI_FLASH_EN25_PREFETCH_SIZE];
+	off_t prefetch_start;
+	/* Number of valid bytes in prefetch_buf, 0 if the window is invalid */
+	size_t prefetch_len;
+	/* End of the last read request, used to detect sequential access */
+	off_t last_read_end;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_STREAM)
+	uint8_t stream_buf[2][CONFIG_SPI_FLASH_EN25_STREAM_CHUNK_SIZE] __aligned(sizeof(long));
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+	/* Transfers of caller buffers the SPI controller cannot use directly go through these */
+	uint8_t bounce_buf[2][CONFIG_SPI_FLASH_EN25_BOUNCE_SIZE]
+		__aligned(MAX(sizeof(long), CONFIG_SPI_FLASH_EN25_BOUNCE_ALIGN));
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BULK_READ)
+	uint8_t bulk_buf[CONFIG_SPI_FLASH_EN25_BULK_READ_BUFS]
+			[CONFIG_SPI_FLASH_EN25_BULK_READ_CHUNK_SIZE] __aligned(sizeof(long));
+	/* One bit per bulk read buffer, set while the driver or the consumer holds it */
+	atomic_t bulk_held;
+	/* Counts free bulk read buffers */
+	struct k_sem bulk_free;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK)
+	/* One bit per erase sector, set while the sector is known to be erased */
+	atomic_t *erased_map;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD) ||                                                   \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT) ||                                         \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE) ||                                   \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+	const struct device *dev;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)
+	/* Pending struct io_request, in order of arrival */
+	sys_dlist_t io_queue;
+	struct k_spinlock io_lock;
+	/* Given whenever a request is queued */
+	struct k_sem io_doorbell;
+	/* End of the last dispatched request, where the elevator continues from */
+	off_t io_head;
+	struct k_thread io_thread;
+	k_thread_stack_t *io_stack;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)
+	/* Protects all QoS state and serializes access to the device between classes */
+	struct k_mutex qos_mutex;
+	struct k_condvar qos_cond;
+	bool qos_busy;
+	uint16_t qos_waiting[SPI_FLASH_EN25_QOS_CLASS_COUNT];
+	struct qos_class qos[SPI_FLASH_EN25_QOS_CLASS_COUNT];
+	struct {
+		k_tid_t thread;
+		enum spi_flash_en25_qos_class cls;
+	} qos_threads[CONFIG_SPI_FLASH_EN25_QOS_MAX_THREADS];
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BORROW)
+	struct borrow_slot borrow[CONFIG_SPI_FLASH_EN25_BORROW_SLOTS];
+	/* Counts free borrow slots */
+	struct k_sem borrow_free;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_POWER_STATS)
+	struct {
+		enum spi_flash_en25_power_state state;
+		/* Uptime in ticks at which the current state was entered */
+		int64_t since;
+		uint64_t ticks[SPI_FLASH_EN25_POWER_STATE_COUNT];
+		bool in_dpd;
+		uint32_t wake_count;
+		uint32_t max_wake_latency_us;
+		uint64_t total_wake_latency_us;
+	} power;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT)
+	struct k_work init_work;
+	/* One of enum init_state */
+	atomic_t init_state;
+	/* Given once bring-up has finished, every waiter gives it back */
+	struct k_sem init_done;
+	int init_err;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD)
+	/* One bit per erase sector, set while the sector is discarded but not yet erased */
+	atomic_t *discard_map;
+	atomic_t discard_count;
+	struct k_work_delayable discard_work;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_WORKQ)
+	/* Runs bring-up and background erases, which would hold up the system work queue */
+	struct k_work_q workq;
+	k_thread_stack_t *workq_stack;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP)
+	/* One cell per erase sector */
+	struct heat_cell *heat;
+	struct k_spinlock heat_lock;
+	uint64_t heat_requested;
+	uint64_t heat_programmed;
+#endif
+#if ANY_INST_HAS_EXT_MUTEX_GPIOS
+	/* Operations of this MCU holding the external mutex pin */
+	atomic_t ext_pin_users;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+	struct gpio_callback ext_cb;
+	/* Protects the handshake state, which the line interrupt also changes */
+	struct k_spinlock ext_lock;
+	/* Given when ownership is gained */
+	struct k_sem ext_sem;
+	/* Hands the flash over once the hold limit is reached while idle */
+	struct k_timer ext_hold_timer;
+	/* Operations holding the flash, and operations waiting for it */
+	uint8_t ext_users;
+	uint8_t ext_waiters;
+	/* Serializes connecting to and leaving the bus, which can sleep */
+	struct k_mutex ext_bus_mutex;
+	bool ext_connected;
+	bool ext_owned;
+	bool ext_requesting;
+	/* The other MCU has been asking for the flash since ext_pending_since */
+	bool ext_pending;
+	int64_t ext_pending_since;
+	struct spi_flash_en25_ext_mutex_stats ext_stats;
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+	/* Set while an emergency save waits for the device, operations in flight give up */
+	atomic_t emergency;
+	/* Cuts the sleep between status polls short when an emergency save starts */
+	struct k_sem emergency_wake;
+	/* One of enum emergency_state */
+	atomic_t emergency_state;
+	/* Checks or erases the emergency save region */
+	struct k_work emergency_work;
+#endif
+};
+
+enum io_op {
+	IO_READ,
+	IO_WRITE,
+	IO_ERASE,
 };
 
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT)
+enum init_state {
+	INIT_PENDING,
+	INIT_RUNNING,
+	INIT_DONE,
+};
+#endif
+
 enum ext_mutex_role {
 	EXT_MUTEX_ROLE_MASTER,
 	EXT_MUTEX_ROLE_SLAVE,
 };
 
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+enum emergency_state {
+	/* Not known yet whether the region is erased */
+	EMERGENCY_CHECKING,
+	EMERGENCY_ARMED,
+	EMERGENCY_SAVING,
+	/* Holds a snapshot until re-armed */
+	EMERGENCY_USED,
+	EMERGENCY_ERASING,
+};
+#endif
+
 struct spi_flash_en25_config {
 	struct spi_dt_spec bus;
 #if ANY_INST_HAS_WP_GPIOS
@@ -102,6 +405,11 @@ struct spi_flash_en25_config {
 	const struct gpio_dt_spec *spi_clk;
 	enum ext_mutex_role ext_mutex_role;
 #endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+	const struct gpio_dt_spec *ext_request;
+	const struct gpio_dt_spec *ext_grant;
+	bool ext_master;
+#endif
 #if IS_ENABLED(CONFIG_FLASH_PAGE_LAYOUT)
 	struct flash_pages_layout pages_layout;
 #endif
@@ -112,9 +420,25 @@ struct spi_flash_en25_config {
 	uint32_t erase_half_block_size;
 	uint32_t erase_sector_size;
 
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BUS_PROFILES)
+	/* Clock frequency per profile, 0 to use spi-max-frequency */
+	uint32_t profile_frequency[BUS_PROFILE_COUNT];
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+	/* Region of emergency saves, size is 0 without one */
+	uint32_t emergency_offset;
+	uint32_t emergency_size;
+#endif
+
 	uint16_t t_enter_dpd; /* in microseconds */
 	uint16_t t_exit_dpd;  /* in microseconds */
 	bool use_udpd;
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_POWER_STATS)
+	/* Datasheet currents per power state, for the energy estimate */
+	uint32_t current_ua[SPI_FLASH_EN25_POWER_STATE_COUNT];
+	uint16_t supply_mv;
+#endif
 	uint8_t jedec_id[3];
 };
 
@@ -132,10 +456,67 @@ static const struct spi_flash_en25_config *get_dev_config(const struct device *d
 	return dev->config;
 }
 
+/*
+ * Bus spec to use for a command. Every profile has its own spi_config, so the SPI controller
+ * applies its settings only when the profile changes between transfers.
+ */
+static const struct spi_dt_spec *bus_for(const struct device *dev, enum bus_profile profile)
+{
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BUS_PROFILES)
+	return &get_dev_data(dev)->bus_profile[profile];
+#else
+	return &get_dev_config(dev)->bus;
+#endif
+}
+
 static void acquire(const struct device *dev) { k_sem_take(&get_dev_data(dev)->lock, K_FOREVER); }
 
 static void release(const struct device *dev) { k_sem_give(&get_dev_data(dev)->lock); }
 
+#if ANY_INST_HAS_EXT_MUTEX_GPIOS || IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+/*
+ * Takes over the SPI bus from the other MCU once the flash is ours.
+ */
+static void ext_bus_connect(const struct device *dev)
+{
+	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
+	const struct spi_cs_control *cs = dev_config->bus.config.cs;
+	int err;
+
+	/* Configure CS pin to output */
+	if (cs && cs->gpio.port) {
+		gpio_pin_configure_dt(&cs->gpio, GPIO_OUTPUT);
+	}
+
+	/* Wake SPI peripheral */
+	err = pm_device_action_run(dev_config->bus.bus, PM_DEVICE_ACTION_RESUME);
+	if (err && err != -EALREADY && err != -ENOSYS) {
+		LOG_ERR("pm_device_action_run, err: %d", err);
+	}
+}
+
+/*
+ * Leaves the SPI bus to the other MCU.
+ */
+static void ext_bus_disconnect(const struct device *dev)
+{
+	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
+	const struct spi_cs_control *cs = dev_config->bus.config.cs;
+	int err;
+
+	/* suspend SPI */
+	err = pm_device_action_run(dev_config->bus.bus, PM_DEVICE_ACTION_SUSPEND);
+	if (err && err != -EALREADY && err != -ENOSYS) {
+		LOG_ERR("pm_device_action_run, err: %d", err);
+	}
+
+	/* Configure CS pin to disconnected */
+	if (cs && cs->gpio.port) {
+		gpio_pin_configure_dt(&cs->gpio, GPIO_INPUT | GPIO_PULL_UP);
+	}
+}
+#endif
+
 #if ANY_INST_HAS_EXT_MUTEX_GPIOS
 
 static int clk_pin_check(const struct gpio_dt_spec *sck_pin)
@@ -202,7 +583,26 @@ static int ext_mutex_pin_wait(const struct device *dev)
 	return -EAGAIN;
 }
 
-static int acquire_ext_mutex(const struct device *dev)
+/*
+ * Joins an operation of this MCU that already drives the pin. The pin reads active then, so
+ * waiting for it to go low would only time out.
+ */
+static bool ext_mutex_pin_join(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	atomic_val_t users = atomic_get(&data->ext_pin_users);
+
+	while (users > 0) {
+		if (atomic_cas(&data->ext_pin_users, users, users + 1)) {
+			return true;
+		}
+		users = atomic_get(&data->ext_pin_users);
+	}
+
+	return false;
+}
+
+static int acquire_ext_mutex_pin(const struct device *dev)
 {
 	int err = 0;
 	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
@@ -212,6 +612,10 @@ static int acquire_ext_mutex(const struct device *dev)
 		return 0;
 	}
 
+	if (ext_mutex_pin_join(dev)) {
+		return 0;
+	}
+
 	/* wait for signal pin to go low */
 	err = ext_mutex_pin_wait(dev);
 	if (err) {
@@ -235,20 +639,12 @@ static int acquire_ext_mutex(const struct device *dev)
 		}
 	}
 
-	/* Configure CS pin to output */
-	if (dev_config->bus.config.cs->gpio.port) {
-		gpio_pin_configure_dt(&dev_config->bus.config.cs->gpio, GPIO_OUTPUT);
-	}
-
-	/* Wake SPI peripheral */
-	err = pm_device_action_run(dev_config->bus.bus, PM_DEVICE_ACTION_RESUME);
-	if (err && err != -EALREADY) {
-		LOG_ERR("pm_device_action_run, err: %d", err);
-	}
+	atomic_inc(&get_dev_data(dev)->ext_pin_users);
+	ext_bus_connect(dev);
 	return 0;
 }
 
-static int release_ext_mutex(const struct device *dev)
+static int release_ext_mutex_pin(const struct device *dev)
 {
 	int err = 0;
 	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
@@ -258,16 +654,12 @@ static int release_ext_mutex(const struct device *dev)
 		return 0;
 	}
 
-	/* suspend SPI */
-	err = pm_device_action_run(dev_config->bus.bus, PM_DEVICE_ACTION_SUSPEND);
-	if (err && err != -EALREADY) {
-		LOG_ERR("pm_device_action_run, err: %d", err);
+	/* Another operation of this MCU still holds the pin */
+	if (atomic_dec(&get_dev_data(dev)->ext_pin_users) > 1) {
+		return 0;
 	}
 
-	/* Configure CS pin to disconnected */
-	if (dev_config->bus.config.cs->gpio.port) {
-		gpio_pin_configure_dt(&dev_config->bus.config.cs->gpio, GPIO_INPUT | GPIO_PULL_UP);
-	}
+	ext_bus_disconnect(dev);
 
 	/* Configure signal pin to input */
 	err = gpio_pin_configure_dt(dev_config->ext_mutex, GPIO_INPUT);
@@ -278,460 +670,4488 @@ static int release_ext_mutex(const struct device *dev)
 	return 0;
 }
 #else
-static int acquire_ext_mutex(const struct device *dev) { return 0; }
-static int release_ext_mutex(const struct device *dev) { return 0; }
+static int acquire_ext_mutex_pin(const struct device *dev) { return 0; }
+static int release_ext_mutex_pin(const struct device *dev) { return 0; }
 #endif /* ANY_INST_HAS_EXT_MUTEX_GPIOS */
 
-static int check_jedec_id(const struct device *dev)
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+/*
+ * Request/grant handshake between two MCUs. The slave drives the request line and the master the
+ * grant line. The master owns the flash unless it has granted it to the slave. The slave owns it
+ * from the grant until it drops its request, which it does once the master lowers the grant to ask
+ * for the flash back. Either side hands the flash over only between operations.
+ */
+
+/* Drives our line to ask for (or keep) the flash, or to hand it to the other MCU */
+static void handshake_drive(const struct device *dev, bool want)
 {
 	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
-	int err;
-	uint8_t const *expected_id = cfg->jedec_id;
-	uint8_t read_id[sizeof(cfg->jedec_id)];
-	const uint8_t opcode = CMD_READ_ID;
-	const struct spi_buf tx_buf[] = {{
-		.buf = (void *)&opcode,
-		.len = sizeof(opcode),
-	}};
-	const struct spi_buf rx_buf[] = {{
-						 .len = sizeof(opcode),
-					 },
-					 {
-						 .buf = read_id,
-						 .len = sizeof(read_id),
-					 }};
-	DEF_BUF_SET(tx_buf_set, tx_buf);
-	DEF_BUF_SET(rx_buf_set, rx_buf);
 
-	err = spi_transceive_dt(&cfg->bus, &tx_buf_set, &rx_buf_set);
-	if (err != 0) {
-		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
-		return -EIO;
+	if (cfg->ext_master) {
+		gpio_pin_set_dt(cfg->ext_grant, !want);
+	} else {
+		gpio_pin_set_dt(cfg->ext_request, want);
 	}
+}
 
-	if (memcmp(expected_id, read_id, sizeof(read_id)) != 0) {
-		LOG_ERR("Wrong JEDEC ID: %02X %02X %02X, "
-			"expected: %02X %02X %02X",
-			read_id[0], read_id[1], read_id[2], expected_id[0], expected_id[1],
-			expected_id[2]);
-		return -ENODEV;
-	}
+static bool handshake_peer_wants(const struct device *dev)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
 
-	return 0;
+	if (cfg->ext_master) {
+		return gpio_pin_get_dt(cfg->ext_request) > 0;
+	}
+	return gpio_pin_get_dt(cfg->ext_grant) == 0;
 }
 
 /*
- * Reads 1-byte Status Register
+ * Hands the flash over if the other MCU is asking for it, no operation is using it and it has
+ * been held for the hold limit since the request. Caller must hold the handshake lock.
  */
-static int read_status_register(const struct device *dev, uint8_t *status)
+static void handshake_yield_if_idle(const struct device *dev)
 {
-	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
-	int err;
-	const uint8_t opcode = CMD_READ_STATUS;
-	const uint8_t empty = 0;
-	const struct spi_buf tx_buf[] = {{
-						 .buf = (void *)&opcode,
-						 .len = sizeof(opcode),
-					 },
-					 {
-						 .buf = (void *)&empty,
-						 .len = sizeof(uint8_t),
-					 }};
-	const struct spi_buf rx_buf[] = {{
-						 .len = sizeof(opcode),
-					 },
-					 {
-						 .buf = status,
-						 .len = sizeof(uint8_t),
-					 }};
-	DEF_BUF_SET(tx_buf_set, tx_buf);
-	DEF_BUF_SET(rx_buf_set, rx_buf);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	struct spi_flash_en25_ext_mutex_stats *stats = &data->ext_stats;
+	int64_t limit = k_ms_to_ticks_ceil64(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HOLD_LIMIT_MS);
+	int64_t held = k_uptime_ticks() - data->ext_pending_since;
+	uint32_t peer_wait_us;
+
+	if (!data->ext_owned || !data->ext_pending || data->ext_users) {
+		return;
+	}
 
-	err = spi_transceive_dt(&cfg->bus, &tx_buf_set, &rx_buf_set);
-	if (err != 0) {
-		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
-		return -EIO;
+	if (held < limit) {
+		k_timer_start(&data->ext_hold_timer, K_TICKS(limit - held), K_NO_WAIT);
+		return;
 	}
 
-	*status = sys_le16_to_cpu(*status);
-	return 0;
+	handshake_drive(dev, false);
+	data->ext_owned = false;
+	data->ext_pending = false;
+	/* Waiting operations now have to ask for the flash back */
+	k_sem_give(&data->ext_sem);
+
+	peer_wait_us = k_ticks_to_us_floor32(held);
+	stats->handoffs++;
+	stats->peer_wait_total_us += peer_wait_us;
+	stats->peer_wait_max_us = MAX(stats->peer_wait_max_us, peer_wait_us);
 }
 
-static int wait_until_ready(const struct device *dev)
+/*
+ * Follows the line of the other MCU. Caller must hold the handshake lock.
+ */
+static void handshake_update(const struct device *dev)
 {
-	int err;
-	uint8_t status;
+	struct spi_flash_en25_data *data = get_dev_data(dev);
 
-	for (int i = 0; i < CONFIG_SPI_FLASH_EN25_READY_TIMEOUT; i++) {
-		err = read_status_register(dev, &status);
-		if (err != 0 || !(status & STATUS_REG_WRITE_IN_PROGRESS)) {
-			return err;
+	if (handshake_peer_wants(dev)) {
+		if (data->ext_owned && !data->ext_pending) {
+			data->ext_pending = true;
+			data->ext_pending_since = k_uptime_ticks();
 		}
-		k_msleep(1);
+		handshake_yield_if_idle(dev);
+		return;
 	}
 
-	/* we are out of the loop so we have timed out */
-	return -ETIMEDOUT;
+	data->ext_pending = false;
+
+	/* The master also takes the flash back when the slave gives up on a grant */
+	if (!data->ext_owned && (data->ext_requesting || get_dev_config(dev)->ext_master)) {
+		if (!data->ext_requesting) {
+			handshake_drive(dev, true);
+		}
+		data->ext_owned = true;
+		data->ext_requesting = false;
+		k_sem_give(&data->ext_sem);
+	}
 }
 
-static int send_cmd_op(const struct device *dev, uint8_t opcode, uint32_t delay)
+static void handshake_line_changed(const struct device *port, struct gpio_callback *cb,
+				   uint32_t pins)
 {
-	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
-	int err = 0;
-	const struct spi_buf tx_buf[] = {{
-		.buf = (void *)&opcode,
-		.len = sizeof(opcode),
-	}};
-	DEF_BUF_SET(tx_buf_set, tx_buf);
+	struct spi_flash_en25_data *data = CONTAINER_OF(cb, struct spi_flash_en25_data, ext_cb);
+	k_spinlock_key_t key = k_spin_lock(&data->ext_lock);
 
-	err = spi_write_dt(&cfg->bus, &tx_buf_set);
+	handshake_update(data->dev);
 
-	if (err != 0) {
-		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
-		return -EIO;
-	}
+	k_spin_unlock(&data->ext_lock, key);
+}
 
-	k_busy_wait(delay);
-	return 0;
+static void handshake_hold_expired(struct k_timer *timer)
+{
+	const struct device *dev = k_timer_user_data_get(timer);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key = k_spin_lock(&data->ext_lock);
+
+	handshake_yield_if_idle(dev);
+
+	k_spin_unlock(&data->ext_lock, key);
 }
 
-static int perform_reset_sequence(const struct device *dev)
+/*
+ * Returns true if a new operation may use the flash now. Once the other MCU has waited for the hold
+ * limit, new operations wait until the flash has been handed over and back. Caller must hold the
+ * handshake lock.
+ */
+static bool handshake_may_use(const struct device *dev)
 {
-	int err;
-	err = send_cmd_op(dev, CMD_RESET_ENABLE, 1);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
 
-	if (err != 0) {
-		return err;
+	if (!data->ext_owned) {
+		return false;
 	}
 
-	err = send_cmd_op(dev, CMD_RESET, 1);
+	return !data->ext_pending ||
+	       k_uptime_ticks() - data->ext_pending_since <
+		       k_ms_to_ticks_ceil64(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HOLD_LIMIT_MS);
+}
 
-	if (err != 0) {
-		return err;
+/*
+ * Connects to the bus while operations use the flash and leaves it to the other MCU once the last
+ * one is done. Only the first and the last of overlapping operations change anything.
+ */
+static void handshake_bus_update(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key;
+	bool in_use;
+
+	k_mutex_lock(&data->ext_bus_mutex, K_FOREVER);
+
+	key = k_spin_lock(&data->ext_lock);
+	in_use = data->ext_users > 0;
+	k_spin_unlock(&data->ext_lock, key);
+
+	if (in_use && !data->ext_connected) {
+		ext_bus_connect(dev);
+	} else if (!in_use && data->ext_connected) {
+		ext_bus_disconnect(dev);
 	}
+	data->ext_connected = in_use;
 
-	err = wait_until_ready(dev);
-	return err;
+	k_mutex_unlock(&data->ext_bus_mutex);
 }
 
-static int set_write_enable(const struct device *dev)
+static int handshake_acquire(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	struct spi_flash_en25_ext_mutex_stats *stats = &data->ext_stats;
+	int64_t start = k_uptime_ticks();
+	int64_t end = start + k_ms_to_ticks_ceil64(CONFIG_SPI_FLASH_EN25_EXTERNAL_MUTEX_TIMEOUT);
+	k_spinlock_key_t key = k_spin_lock(&data->ext_lock);
+	bool waited = false;
+
+	while (!handshake_may_use(dev)) {
+		int64_t left = end - k_uptime_ticks();
+
+		waited = true;
+
+		if (!data->ext_owned && !data->ext_requesting) {
+			data->ext_requesting = true;
+			handshake_drive(dev, true);
+			/* The other MCU might not be using the flash at all */
+			handshake_update(dev);
+			continue;
+		}
+
+		if (left <= 0) {
+			if (data->ext_requesting && !data->ext_waiters) {
+				data->ext_requesting = false;
+				handshake_drive(dev, false);
+			}
+			stats->timeouts++;
+			k_spin_unlock(&data->ext_lock, key);
+			LOG_ERR("Timed out waiting for the other MCU to hand over the flash");
+			return -EAGAIN;
+		}
+
+		data->ext_waiters++;
+		k_spin_unlock(&data->ext_lock, key);
+		(void)k_sem_take(&data->ext_sem, K_TICKS(left));
+		key = k_spin_lock(&data->ext_lock);
+		data->ext_waiters--;
+	}
+
+	data->ext_users++;
+
+	if (waited) {
+		uint32_t wait_us = k_ticks_to_us_floor32(k_uptime_ticks() - start);
+
+		stats->waits++;
+		stats->wait_total_us += wait_us;
+		stats->wait_max_us = MAX(stats->wait_max_us, wait_us);
+	}
+
+	k_spin_unlock(&data->ext_lock, key);
+
+	/* Other threads of this MCU may be waiting as well */
+	k_sem_give(&data->ext_sem);
+
+	handshake_bus_update(dev);
+	return 0;
+}
+
+static int handshake_release(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key;
+
+	k_mutex_lock(&data->ext_bus_mutex, K_FOREVER);
+
+	/*
+	 * The last user leaves the bus before the flash can be handed over. A user that arrives in
+	 * the meantime connects again once the mutex is free.
+	 */
+	if (data->ext_users == 1 && data->ext_connected) {
+		ext_bus_disconnect(dev);
+		data->ext_connected = false;
+	}
+
+	key = k_spin_lock(&data->ext_lock);
+	data->ext_users--;
+	handshake_yield_if_idle(dev);
+	k_spin_unlock(&data->ext_lock, key);
+
+	k_mutex_unlock(&data->ext_bus_mutex);
+
+	return 0;
+}
+
+static int handshake_init(const struct device *dev)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	const struct gpio_dt_spec *in = cfg->ext_master ? cfg->ext_request : cfg->ext_grant;
+	const struct gpio_dt_spec *out = cfg->ext_master ? cfg->ext_grant : cfg->ext_request;
+	k_spinlock_key_t key;
+
+	if (!cfg->ext_request || !cfg->ext_grant) {
+		LOG_ERR("Both ext-mutex-request-gpios and ext-mutex-grant-gpios are needed");
+		return -EINVAL;
+	}
+
+	k_sem_init(&data->ext_sem, 0, 1);
+	k_mutex_init(&data->ext_bus_mutex);
+	k_timer_init(&data->ext_hold_timer, handshake_hold_expired, NULL);
+	k_timer_user_data_set(&data->ext_hold_timer, (void *)dev);
+
+	/* Both start inactive: the slave does not request, the master does not grant. This also
+	 * asks for the flash back if the master restarted while the slave owned it. */
+	if (gpio_pin_configure_dt(out, GPIO_OUTPUT_INACTIVE) ||
+	    gpio_pin_configure_dt(in, GPIO_INPUT)) {
+		LOG_ERR("Couldn't configure ext mutex handshake pins");
+		return -EIO;
+	}
+
+	gpio_init_callback(&data->ext_cb, handshake_line_changed, BIT(in->pin));
+	if (gpio_add_callback(in->port, &data->ext_cb) ||
+	    gpio_pin_interrupt_configure_dt(in, GPIO_INT_EDGE_BOTH)) {
+		LOG_ERR("Couldn't configure ext mutex handshake interrupt");
+		return -EIO;
+	}
+
+	key = k_spin_lock(&data->ext_lock);
+	data->ext_requesting = cfg->ext_master;
+	handshake_update(dev);
+	k_spin_unlock(&data->ext_lock, key);
+
+	return 0;
+}
+
+int spi_flash_en25_ext_mutex_stats_get(const struct device *dev,
+				       struct spi_flash_en25_ext_mutex_stats *stats, bool reset)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key;
+
+	if (!get_dev_config(dev)->ext_request) {
+		return -ENOTSUP;
+	}
+
+	key = k_spin_lock(&data->ext_lock);
+	*stats = data->ext_stats;
+	if (reset) {
+		memset(&data->ext_stats, 0, sizeof(data->ext_stats));
+	}
+	k_spin_unlock(&data->ext_lock, key);
+
+	return 0;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE) */
+
+/*
+ * Returns true if another MCU can use the flash, so its contents can change behind our back.
+ */
+static bool has_ext_mutex(const struct device *dev)
+{
+#if ANY_INST_HAS_EXT_MUTEX_GPIOS
+	if (get_dev_config(dev)->ext_mutex) {
+		return true;
+	}
+#endif
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+	if (get_dev_config(dev)->ext_request) {
+		return true;
+	}
+#endif
+	return false;
+}
+
+static int acquire_ext_mutex(const struct device *dev)
+{
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+	if (get_dev_config(dev)->ext_request) {
+		return handshake_acquire(dev);
+	}
+#endif
+	return acquire_ext_mutex_pin(dev);
+}
+
+static int release_ext_mutex(const struct device *dev)
+{
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+	if (get_dev_config(dev)->ext_request) {
+		return handshake_release(dev);
+	}
+#endif
+	return release_ext_mutex_pin(dev);
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT)
+static int bring_up(const struct device *dev);
+static void emergency_boot_check(const struct device *dev);
+
+static void run_init(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	data->init_err = bring_up(dev);
+	if (data->init_err != 0) {
+		LOG_ERR("Deferred init failed, err: %d", data->init_err);
+	} else {
+		emergency_boot_check(dev);
+	}
+
+	atomic_set(&data->init_state, INIT_DONE);
+	k_sem_give(&data->init_done);
+}
+
+static void init_work_handler(struct k_work *work)
+{
+	struct spi_flash_en25_data *data =
+		CONTAINER_OF(work, struct spi_flash_en25_data, init_work);
+
+	/* The first API call may have already taken over */
+	if (atomic_cas(&data->init_state, INIT_PENDING, INIT_RUNNING)) {
+		run_init(data->dev);
+	}
+}
+
+/*
+ * Waits until the chip has been brought up. If the work item has not started yet, bring-up runs
+ * in the calling thread instead, so a caller on the driver work queue can not deadlock.
+ */
+static int wait_for_init(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	if (atomic_get(&data->init_state) == INIT_DONE) {
+		return data->init_err;
+	}
+
+	if (atomic_cas(&data->init_state, INIT_PENDING, INIT_RUNNING)) {
+		run_init(dev);
+	} else {
+		k_sem_take(&data->init_done, K_FOREVER);
+		k_sem_give(&data->init_done);
+	}
+
+	return data->init_err;
+}
+#else
+static int wait_for_init(const struct device *dev) { return 0; }
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_POWER_STATS)
+/*
+ * Accounts the time spent in the current state and switches to a new one. Returns the previous
+ * state. Caller must hold the device lock.
+ */
+static enum spi_flash_en25_power_state power_set(const struct device *dev,
+						 enum spi_flash_en25_power_state state)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	enum spi_flash_en25_power_state prev = data->power.state;
+	int64_t now = k_uptime_ticks();
+
+	data->power.ticks[prev] += now - data->power.since;
+	data->power.since = now;
+	data->power.state = state;
+
+	return prev;
+}
+
+/*
+ * State the chip returns to when the device lock is released.
+ */
+static enum spi_flash_en25_power_state power_idle_state(const struct device *dev)
+{
+	return get_dev_data(dev)->power.in_dpd ? SPI_FLASH_EN25_POWER_DPD
+					       : SPI_FLASH_EN25_POWER_STANDBY;
+}
+
+static void power_dpd_changed(const struct device *dev, bool in_dpd, uint32_t latency_us)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	data->power.in_dpd = in_dpd;
+
+	if (!in_dpd) {
+		data->power.wake_count++;
+		data->power.total_wake_latency_us += latency_us;
+		data->power.max_wake_latency_us = MAX(data->power.max_wake_latency_us, latency_us);
+	}
+}
+#else
+static enum spi_flash_en25_power_state power_set(const struct device *dev,
+						 enum spi_flash_en25_power_state state)
+{
+	return SPI_FLASH_EN25_POWER_STANDBY;
+}
+static enum spi_flash_en25_power_state power_idle_state(const struct device *dev)
+{
+	return SPI_FLASH_EN25_POWER_STANDBY;
+}
+static void power_dpd_changed(const struct device *dev, bool in_dpd, uint32_t latency_us) {}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_POWER_STATS) */
+
+/*
+ * Takes the external mutex (if configured) and then the device lock. Callers that can only run
+ * after the device was initialized skip the deferred init wait with `initialized`.
+ */
+static int lock_device_common(const struct device *dev, bool initialized)
+{
+	int err = initialized ? 0 : wait_for_init(dev);
+	if (err) {
+		return err;
+	}
+
+	err = acquire_ext_mutex(dev);
+	if (err) {
+		return err;
+	}
+
+	acquire(dev);
+
+	/* Commands sent in deep power-down are ignored, so the chip stays there */
+	if (power_idle_state(dev) != SPI_FLASH_EN25_POWER_DPD) {
+		(void)power_set(dev, SPI_FLASH_EN25_POWER_ACTIVE);
+	}
+
+	return 0;
+}
+
+static int lock_device(const struct device *dev)
+{
+	return lock_device_common(dev, false);
+}
+
+static int unlock_device(const struct device *dev)
+{
+	(void)power_set(dev, power_idle_state(dev));
+	release(dev);
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD)
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	/* Every operation restarts the idle period before discarded sectors are erased */
+	if (atomic_get(&data->discard_count)) {
+		k_work_reschedule_for_queue(&data->workq, &data->discard_work,
+					    K_MSEC(CONFIG_SPI_FLASH_EN25_DISCARD_IDLE_TIMEOUT));
+	}
+#endif
+
+	return release_ext_mutex(dev);
+}
+
+static int check_jedec_id(const struct device *dev)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err;
+	uint8_t const *expected_id = cfg->jedec_id;
+	uint8_t read_id[sizeof(cfg->jedec_id)];
+	const uint8_t opcode = CMD_READ_ID;
+	const struct spi_buf tx_buf[] = {{
+		.buf = (void *)&opcode,
+		.len = sizeof(opcode),
+	}};
+	const struct spi_buf rx_buf[] = {{
+						 .len = sizeof(opcode),
+					 },
+					 {
+						 .buf = read_id,
+						 .len = sizeof(read_id),
+					 }};
+	DEF_BUF_SET(tx_buf_set, tx_buf);
+	DEF_BUF_SET(rx_buf_set, rx_buf);
+
+	err = spi_transceive_dt(&cfg->bus, &tx_buf_set, &rx_buf_set);
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+		return -EIO;
+	}
+
+	if (memcmp(expected_id, read_id, sizeof(read_id)) != 0) {
+		LOG_ERR("Wrong JEDEC ID: %02X %02X %02X, "
+			"expected: %02X %02X %02X",
+			read_id[0], read_id[1], read_id[2], expected_id[0], expected_id[1],
+			expected_id[2]);
+		return -ENODEV;
+	}
+
+	return 0;
+}
+
+/*
+ * Reads 1-byte Status Register
+ */
+static int read_status_register(const struct device *dev, uint8_t *status)
+{
+	int err;
+	const uint8_t opcode = CMD_READ_STATUS;
+	const uint8_t empty = 0;
+	const struct spi_buf tx_buf[] = {{
+						 .buf = (void *)&opcode,
+						 .len = sizeof(opcode),
+					 },
+					 {
+						 .buf = (void *)&empty,
+						 .len = sizeof(uint8_t),
+					 }};
+	const struct spi_buf rx_buf[] = {{
+						 .len = sizeof(opcode),
+					 },
+					 {
+						 .buf = status,
+						 .len = sizeof(uint8_t),
+					 }};
+	DEF_BUF_SET(tx_buf_set, tx_buf);
+	DEF_BUF_SET(rx_buf_set, rx_buf);
+
+	err = spi_transceive_dt(bus_for(dev, BUS_STATUS), &tx_buf_set, &rx_buf_set);
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+		return -EIO;
+	}
+
+	*status = sys_le16_to_cpu(*status);
+	return 0;
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+/*
+ * Returns true while an emergency save waits for the device, so the operation holding it gives
+ * up instead of waiting for the chip.
+ */
+static bool emergency_pending(const struct device *dev)
+{
+	return atomic_get(&get_dev_data(dev)->emergency) != 0;
+}
+
+/*
+ * Sleeps for a millisecond between status polls, unless an emergency save starts meanwhile.
+ */
+static void ready_poll_sleep(const struct device *dev)
+{
+	(void)k_sem_take(&get_dev_data(dev)->emergency_wake, K_MSEC(1));
+}
+#else
+static bool emergency_pending(const struct device *dev) { return false; }
+static void ready_poll_sleep(const struct device *dev) { k_msleep(1); }
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE) */
+
+static int wait_until_ready(const struct device *dev)
+{
+	enum spi_flash_en25_power_state prev = power_set(dev, SPI_FLASH_EN25_POWER_BUSY);
+	int err;
+	uint8_t status;
+
+	/* we time out if we get through the whole loop */
+	err = -ETIMEDOUT;
+
+	for (int i = 0; i < CONFIG_SPI_FLASH_EN25_READY_TIMEOUT; i++) {
+		err = read_status_register(dev, &status);
+		if (err != 0 || !(status & STATUS_REG_WRITE_IN_PROGRESS)) {
+			break;
+		}
+		if (emergency_pending(dev)) {
+			err = -ECANCELED;
+			break;
+		}
+		err = -ETIMEDOUT;
+		ready_poll_sleep(dev);
+	}
+
+	(void)power_set(dev, prev);
+
+	return err;
+}
+
+/*
+ * Polls the status register without sleeping. Meant for short operations like page programs,
+ * where sleeping for a whole millisecond would take longer than the operation itself.
+ */
+static int poll_until_ready(const struct device *dev, uint32_t poll_us, uint32_t timeout_us)
+{
+	enum spi_flash_en25_power_state prev = power_set(dev, SPI_FLASH_EN25_POWER_BUSY);
+	int err = -ETIMEDOUT;
+	uint8_t status;
+
+	for (uint32_t waited = 0; waited <= timeout_us; waited += poll_us) {
+		err = read_status_register(dev, &status);
+		if (err != 0 || !(status & STATUS_REG_WRITE_IN_PROGRESS)) {
+			break;
+		}
+		if (emergency_pending(dev)) {
+			err = -ECANCELED;
+			break;
+		}
+		err = -ETIMEDOUT;
+		k_busy_wait(poll_us);
+	}
+
+	(void)power_set(dev, prev);
+
+	return err;
+}
+
+static int send_cmd_op(const struct device *dev, uint8_t opcode, uint32_t delay)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err = 0;
+	const struct spi_buf tx_buf[] = {{
+		.buf = (void *)&opcode,
+		.len = sizeof(opcode),
+	}};
+	DEF_BUF_SET(tx_buf_set, tx_buf);
+
+	err = spi_write_dt(&cfg->bus, &tx_buf_set);
+
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+		return -EIO;
+	}
+
+	k_busy_wait(delay);
+	return 0;
+}
+
+/*
+ * Sends the software reset, without waiting for the chip to come back.
+ */
+static int send_reset(const struct device *dev)
+{
+	int err;
+	err = send_cmd_op(dev, CMD_RESET_ENABLE, 1);
+
+	if (err != 0) {
+		return err;
+	}
+
+	return send_cmd_op(dev, CMD_RESET, 1);
+}
+
+static int perform_reset_sequence(const struct device *dev)
+{
+	int err;
+	err = send_reset(dev);
+
+	if (err != 0) {
+		return err;
+	}
+
+	err = wait_until_ready(dev);
+	return err;
+}
+
+static int set_write_enable(const struct device *dev)
 {
 	/* We add minimal delay of one microsecond, although datasheet says
 	 * that it could be 30ns. */
 	return send_cmd_op(dev, CMD_WRITE_ENABLE, 1);
 }
 
-static bool is_valid_request(off_t addr, size_t size, size_t chip_size)
+static inline bool is_valid_request(off_t addr, size_t size, size_t chip_size)
+{
+	/* Unsigned compare also catches negative offsets and overflowing sizes */
+	return ((size_t)addr <= chip_size) && (size <= chip_size - (size_t)addr);
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_SPI_FLASH_EN25_BOUNCE_ALIGN),
+	     "CONFIG_SPI_FLASH_EN25_BOUNCE_ALIGN must be a power of two");
+
+/*
+ * Whether the SPI controller can transfer to or from a buffer directly. It has to be aligned and,
+ * if the board names its RAM, lie in it. Buffers without data are always fine.
+ */
+static bool dma_capable(const void *buf, size_t len)
+{
+	uintptr_t addr = (uintptr_t)buf;
+
+	if (!buf || !len) {
+		return true;
+	}
+
+	if (addr % CONFIG_SPI_FLASH_EN25_BOUNCE_ALIGN) {
+		return false;
+	}
+
+#if DT_HAS_CHOSEN(zephyr_sram)
+	return addr >= DT_REG_ADDR(DT_CHOSEN(zephyr_sram)) &&
+	       addr - DT_REG_ADDR(DT_CHOSEN(zephyr_sram)) + len <=
+		       DT_REG_SIZE(DT_CHOSEN(zephyr_sram));
+#else
+	return true;
+#endif
+}
+
+static bool bufs_dma_capable(const struct spi_buf *bufs, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (!dma_capable(bufs[i].buf, bufs[i].len)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int bounce_read(const struct device *dev, off_t offset, void *data, size_t len);
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE) */
+
+/*
+ * Reads consecutive bytes into a list of buffers with a single read command.
+ */
+static int perform_read_bufs(const struct device *dev, off_t offset, const struct spi_buf *bufs,
+			     size_t count)
+{
+	int err;
+
+	__ASSERT_NO_MSG(count <= MAX_DATA_BUFS);
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+	/* Buffers are read one by one then, the ones the controller cannot use through the pool */
+	if (!bufs_dma_capable(bufs, count)) {
+		for (size_t i = 0; i < count; i++) {
+			err = dma_capable(bufs[i].buf, bufs[i].len)
+				      ? perform_read_bufs(dev, offset, &bufs[i], 1)
+				      : bounce_read(dev, offset, bufs[i].buf, bufs[i].len);
+			if (err != 0) {
+				return err;
+			}
+			offset += bufs[i].len;
+		}
+
+		return 0;
+	}
+#endif
+
+	uint8_t const op_and_addr[] = {
+		CMD_READ,
+		(offset >> 16) & 0xFF,
+		(offset >> 8) & 0xFF,
+		(offset >> 0) & 0xFF,
+	};
+	const struct spi_buf tx_buf[] = {{
+		.buf = (void *)&op_and_addr,
+		.len = sizeof(op_and_addr),
+	}};
+	struct spi_buf rx_buf[1 + MAX_DATA_BUFS] = {{
+		.len = sizeof(op_and_addr),
+	}};
+	DEF_BUF_SET(tx_buf_set, tx_buf);
+	const struct spi_buf_set rx_buf_set = {
+		.buffers = rx_buf,
+		.count = 1 + count,
+	};
+
+	memcpy(&rx_buf[1], bufs, count * sizeof(*bufs));
+
+	err = spi_transceive_dt(bus_for(dev, BUS_READ), &tx_buf_set, &rx_buf_set);
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+	}
+
+	return (err != 0) ? -EIO : 0;
+}
+
+#if HOLD_PREEMPT_ENABLED
+/*
+ * Takes the bus by clocking a single byte with the chip deselected or held, which the chip
+ * ignores. The bus stays locked until it is released.
+ */
+static int hold_take_bus(const struct device *dev)
+{
+	uint8_t dummy;
+	const struct spi_buf rx_buf[] = {{
+		.buf = &dummy,
+		.len = sizeof(dummy),
+	}};
+	DEF_BUF_SET(rx_buf_set, rx_buf);
+
+	return spi_read_dt(&get_dev_data(dev)->bus_hold, &rx_buf_set);
+}
+
+/*
+ * Reads a long region with a single read command, but hands the bus to other users every
+ * hold_block_len bytes. Chip select is driven here so it stays asserted while the bus is released,
+ * and HOLD# keeps the chip off the bus in the meantime. Caller must hold the device lock.
+ */
+static int hold_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
+	struct spi_flash_en25_data *dev_data = get_dev_data(dev);
+	const struct spi_cs_control *cs = dev_config->bus.config.cs;
+	uint8_t *dst = data;
+	size_t chunk = MIN(len, dev_data->hold_block_len);
+	int hold_err;
+	int cs_err;
+	int err;
+
+	uint8_t const op_and_addr[] = {
+		CMD_READ,
+		(offset >> 16) & 0xFF,
+		(offset >> 8) & 0xFF,
+		(offset >> 0) & 0xFF,
+	};
+	const struct spi_buf tx_buf[] = {{
+		.buf = (void *)&op_and_addr,
+		.len = sizeof(op_and_addr),
+	}};
+	struct spi_buf rx_buf[] = {
+		{
+			.len = sizeof(op_and_addr),
+		},
+		{
+			.buf = dst,
+			.len = chunk,
+		},
+	};
+	DEF_BUF_SET(tx_buf_set, tx_buf);
+	DEF_BUF_SET(rx_buf_set, rx_buf);
+
+	err = hold_take_bus(dev);
+	if (err == 0) {
+		err = gpio_pin_set_dt(&cs->gpio, 1);
+	}
+	if (err == 0) {
+		k_busy_wait(cs->delay);
+		err = spi_transceive_dt(&dev_data->bus_hold, &tx_buf_set, &rx_buf_set);
+	}
+
+	while (err == 0 && len > chunk) {
+		const struct spi_buf data_buf[] = {{
+			.buf = dst + chunk,
+			.len = MIN(len - chunk, dev_data->hold_block_len),
+		}};
+		DEF_BUF_SET(data_buf_set, data_buf);
+
+		dst += chunk;
+		len -= chunk;
+		chunk = data_buf[0].len;
+
+		/* Pause the read, let other bus users run, then continue where it stopped */
+		err = gpio_pin_set_dt(dev_config->hold, 0);
+		if (err != 0) {
+			break;
+		}
+		spi_release_dt(&dev_data->bus_hold);
+		k_yield();
+		err = hold_take_bus(dev);
+		/* HOLD# must not stay asserted, even if the bus could not be taken */
+		hold_err = gpio_pin_set_dt(dev_config->hold, 1);
+		if (err == 0) {
+			err = hold_err;
+		}
+		if (err == 0) {
+			err = spi_read_dt(&dev_data->bus_hold, &data_buf_set);
+		}
+	}
+
+	k_busy_wait(cs->delay);
+	cs_err = gpio_pin_set_dt(&cs->gpio, 0);
+	spi_release_dt(&dev_data->bus_hold);
+
+	if (err == 0) {
+		err = cs_err;
+	}
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+	}
+
+	return (err != 0) ? -EIO : 0;
+}
+
+/*
+ * Sets up paused reads if the instance has a hold pin and a GPIO chip select.
+ */
+static void hold_preempt_init(const struct device *dev)
+{
+	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
+	struct spi_flash_en25_data *dev_data = get_dev_data(dev);
+	const struct spi_cs_control *cs = dev_config->bus.config.cs;
+	uint64_t block_len;
+
+	if (!dev_config->hold) {
+		return;
+	}
+	if (!cs || !cs->gpio.port) {
+		LOG_WRN("HOLD# preemption needs a GPIO chip select");
+		return;
+	}
+
+	dev_data->bus_hold = *bus_for(dev, BUS_READ);
+	dev_data->bus_hold.config.cs = NULL;
+	dev_data->bus_hold.config.operation |= SPI_LOCK_ON;
+
+	block_len = (uint64_t)dev_data->bus_hold.config.frequency / 8 *
+		    CONFIG_SPI_FLASH_EN25_HOLD_MAX_BLOCK_US / USEC_PER_SEC;
+	dev_data->hold_block_len = MAX(block_len, HOLD_MIN_BLOCK_LEN);
+}
+#endif /* HOLD_PREEMPT_ENABLED */
+
+static int perform_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+	const struct spi_buf buf = {
+		.buf = data,
+		.len = len,
+	};
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+	if (!dma_capable(data, len)) {
+		return bounce_read(dev, offset, data, len);
+	}
+#endif
+
+#if HOLD_PREEMPT_ENABLED
+	if (get_dev_data(dev)->hold_block_len && len > get_dev_data(dev)->hold_block_len) {
+		return hold_read(dev, offset, data, len);
+	}
+#endif
+
+	return perform_read_bufs(dev, offset, &buf, 1);
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_PREFETCH)
+/*
+ * Drops the prefetch window if it overlaps the given region. Must be called before the region is
+ * written or erased.
+ */
+static void prefetch_invalidate(const struct device *dev, off_t offset, size_t len)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	if (data->prefetch_len && offset < data->prefetch_start + (off_t)data->prefetch_len &&
+	    data->prefetch_start < offset + (off_t)len) {
+		data->prefetch_len = 0;
+	}
+}
+
+/*
+ * Serves reads from the prefetch window when possible. When a read continues where the previous
+ * one ended, a full window is fetched starting at the requested offset so the following reads can
+ * be served from RAM. Caller must hold the device lock.
+ */
+static int prefetch_read(const struct device *dev, off_t offset, void *buf, size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	bool sequential = (offset == data->last_read_end);
+	off_t window_end = data->prefetch_start + data->prefetch_len;
+	int err;
+
+	/* The other MCU can change the flash contents without us knowing */
+	if (has_ext_mutex(dev)) {
+		return perform_read(dev, offset, buf, len);
+	}
+
+	data->last_read_end = offset + len;
+
+	/* Copy whatever we already have */
+	if (data->prefetch_len && offset >= data->prefetch_start && offset < window_end) {
+		size_t chunk_len = MIN(len, window_end - offset);
+
+		memcpy(buf, &data->prefetch_buf[offset - data->prefetch_start], chunk_len);
+		buf = (uint8_t *)buf + chunk_len;
+		offset += chunk_len;
+		len -= chunk_len;
+
+		if (!len) {
+			return 0;
+		}
+	}
+
+	if (!sequential || len >= sizeof(data->prefetch_buf)) {
+		return perform_read(dev, offset, buf, len);
+	}
+
+	data->prefetch_len = 0;
+	data->prefetch_start = offset;
+
+	size_t window_len = MIN(sizeof(data->prefetch_buf), CHIP_SIZE(cfg) - offset);
+
+	err = perform_read(dev, offset, data->prefetch_buf, window_len);
+	if (err != 0) {
+		return err;
+	}
+	data->prefetch_len = window_len;
+
+	memcpy(buf, data->prefetch_buf, len);
+	return 0;
+}
+#else
+static void prefetch_invalidate(const struct device *dev, off_t offset, size_t len) {}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_PREFETCH) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK)
+/*
+ * Returns the erased sector bitmap of the device, or NULL if the erased state can not be tracked.
+ */
+static atomic_t *get_erased_map(const struct device *dev)
+{
+	/* The other MCU can write to the flash without us knowing */
+	if (has_ext_mutex(dev)) {
+		return NULL;
+	}
+	return get_dev_data(dev)->erased_map;
+}
+
+static bool sector_known_erased(const struct device *dev, off_t offset)
+{
+	atomic_t *map = get_erased_map(dev);
+
+	return map && atomic_test_bit(map, offset / ERASE_SECTOR_SIZE(get_dev_config(dev)));
+}
+
+/*
+ * Marks sectors as erased or not. Only sectors that are completely covered by the region are
+ * marked as erased, while every sector touched by the region is marked as not erased.
+ */
+static void erased_map_update(const struct device *dev, off_t offset, size_t len, bool erased)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	atomic_t *map = get_erased_map(dev);
+	off_t first, last;
+
+	if (!map || !len) {
+		return;
+	}
+
+	if (erased) {
+		first = DIV_ROUND_UP(offset, ERASE_SECTOR_SIZE(cfg));
+		last = (offset + len) / ERASE_SECTOR_SIZE(cfg);
+	} else {
+		first = offset / ERASE_SECTOR_SIZE(cfg);
+		last = DIV_ROUND_UP(offset + len, ERASE_SECTOR_SIZE(cfg));
+	}
+
+	for (off_t sector = first; sector < last; sector++) {
+		atomic_set_bit_to(map, sector, erased);
+	}
+}
+#else
+static void erased_map_update(const struct device *dev, off_t offset, size_t len, bool erased) {}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BORROW)
+/*
+ * Marks borrowed buffers that overlap the region as stale. The buffers themselves stay untouched
+ * until they are released.
+ */
+static void borrow_invalidate(const struct device *dev, off_t offset, size_t len)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	for (size_t i = 0; i < ARRAY_SIZE(data->borrow); i++) {
+		struct borrow_slot *slot = &data->borrow[i];
+
+		if (slot->in_use && offset < slot->offset + (off_t)slot->len &&
+		    slot->offset < offset + (off_t)len) {
+			slot->stale = true;
+		}
+	}
+}
+#else
+static void borrow_invalidate(const struct device *dev, off_t offset, size_t len) {}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BORROW) */
+
+/*
+ * Must be called before a region is programmed, so cached state about it can be dropped.
+ */
+static void region_programmed(const struct device *dev, off_t offset, size_t len)
+{
+	prefetch_invalidate(dev, offset, len);
+	erased_map_update(dev, offset, len, false);
+	borrow_invalidate(dev, offset, len);
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD)
+static int perform_erase_op(const struct device *dev, uint8_t opcode, off_t offset);
+
+/*
+ * Clears the discard flag of sectors that are completely covered by an erase.
+ */
+static void discard_clear(const struct device *dev, off_t offset, size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	off_t last = (offset + len) / ERASE_SECTOR_SIZE(cfg);
+
+	for (off_t sector = DIV_ROUND_UP(offset, ERASE_SECTOR_SIZE(cfg)); sector < last;
+	     sector++) {
+		if (atomic_test_and_clear_bit(data->discard_map, sector)) {
+			atomic_dec(&data->discard_count);
+		}
+	}
+}
+
+/*
+ * Whether the erase sector holding @p offset is discarded and not erased yet. Its next program
+ * erases it, so none of its old contents survive.
+ */
+static bool discard_pending(const struct device *dev, off_t offset)
+{
+	return atomic_test_bit(get_dev_data(dev)->discard_map,
+			       offset / ERASE_SECTOR_SIZE(get_dev_config(dev)));
+}
+
+/*
+ * Erases discarded sectors that are about to be programmed. Caller must hold the device lock.
+ */
+static int discard_resolve(const struct device *dev, off_t offset, size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	off_t last = DIV_ROUND_UP(offset + len, ERASE_SECTOR_SIZE(cfg));
+	int err;
+
+	if (!atomic_get(&data->discard_count)) {
+		return 0;
+	}
+
+	for (off_t sector = offset / ERASE_SECTOR_SIZE(cfg); sector < last; sector++) {
+		if (!atomic_test_bit(data->discard_map, sector)) {
+			continue;
+		}
+
+		err = perform_erase_op(dev, CMD_SECTOR_ERASE, sector * ERASE_SECTOR_SIZE(cfg));
+		if (err != 0) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+#else
+static void discard_clear(const struct device *dev, off_t offset, size_t len) {}
+static bool discard_pending(const struct device *dev, off_t offset) { return false; }
+static int discard_resolve(const struct device *dev, off_t offset, size_t len) { return 0; }
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD) */
+
+/*
+ * Must be called before a region is erased. Until the erase has completed, the contents of the
+ * region are unknown, so it is treated like a programmed one.
+ */
+static void region_erasing(const struct device *dev, off_t offset, size_t len)
+{
+	region_programmed(dev, offset, len);
+}
+
+/*
+ * Must be called after a region was erased successfully.
+ */
+static void region_erased(const struct device *dev, off_t offset, size_t len)
+{
+	erased_map_update(dev, offset, len, true);
+	discard_clear(dev, offset, len);
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP)
+static void heat_add(heat_t *counter, uint32_t n)
+{
+	*counter += MIN(n, (uint32_t)(HEAT_MAX - *counter));
+}
+
+/*
+ * Counts an erase of every sector in the region.
+ */
+static void heat_erased(const struct device *dev, off_t offset, size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	size_t end = (offset + len) / ERASE_SECTOR_SIZE(cfg);
+
+	/* A chip erase covers every sector, so the lock is only held for one at a time */
+	for (size_t i = offset / ERASE_SECTOR_SIZE(cfg); i < end; i++) {
+		k_spinlock_key_t key = k_spin_lock(&data->heat_lock);
+
+		heat_add(&data->heat[i].erases, 1);
+
+		k_spin_unlock(&data->heat_lock, key);
+	}
+}
+
+/*
+ * Counts a page program, which never crosses a sector boundary.
+ */
+static void heat_programmed(const struct device *dev, off_t offset, size_t len)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	struct heat_cell *cell = &data->heat[offset / ERASE_SECTOR_SIZE(get_dev_config(dev))];
+	k_spinlock_key_t key = k_spin_lock(&data->heat_lock);
+
+	heat_add(&cell->programs, 1);
+	heat_add(&cell->bytes, len);
+	data->heat_programmed += len;
+
+	k_spin_unlock(&data->heat_lock, key);
+}
+
+static void heat_requested(const struct device *dev, size_t len)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key = k_spin_lock(&data->heat_lock);
+
+	data->heat_requested += len;
+
+	k_spin_unlock(&data->heat_lock, key);
+}
+
+static uint32_t heat_sectors(const struct device *dev)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+
+	return CHIP_SIZE(cfg) / ERASE_SECTOR_SIZE(cfg);
+}
+
+int spi_flash_en25_heatmap_get(const struct device *dev, uint32_t first_sector,
+			       struct spi_flash_en25_heatmap_entry *entries, size_t count)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key;
+
+	if (first_sector > heat_sectors(dev) || count > heat_sectors(dev) - first_sector) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->heat_lock);
+	for (size_t i = 0; i < count; i++) {
+		const struct heat_cell *cell = &data->heat[first_sector + i];
+
+		entries[i].erases = cell->erases;
+		entries[i].programs = cell->programs;
+		entries[i].bytes = cell->bytes;
+	}
+	k_spin_unlock(&data->heat_lock, key);
+
+	return 0;
+}
+
+int spi_flash_en25_heatmap_summary_get(const struct device *dev,
+				       struct spi_flash_en25_heatmap_summary *summary)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key;
+
+	memset(summary, 0, sizeof(*summary));
+	summary->sectors = heat_sectors(dev);
+	summary->sector_size = ERASE_SECTOR_SIZE(get_dev_config(dev));
+
+	key = k_spin_lock(&data->heat_lock);
+	summary->bytes_requested = data->heat_requested;
+	summary->bytes_programmed = data->heat_programmed;
+	k_spin_unlock(&data->heat_lock, key);
+
+	/* Interrupts are only locked for one sector at a time, the summary is not a snapshot */
+	for (uint32_t i = 0; i < summary->sectors; i++) {
+		struct heat_cell cell;
+
+		key = k_spin_lock(&data->heat_lock);
+		cell = data->heat[i];
+		k_spin_unlock(&data->heat_lock, key);
+
+		if (cell.erases > summary->max_erases) {
+			summary->max_erases = cell.erases;
+			summary->hottest_sector = i;
+		}
+		summary->total_erases += cell.erases;
+		if (cell.erases == HEAT_MAX || cell.programs == HEAT_MAX ||
+		    cell.bytes == HEAT_MAX) {
+			summary->saturated++;
+		}
+	}
+
+	if (summary->bytes_requested) {
+		summary->write_amplification_milli =
+			summary->bytes_programmed * 1000 / summary->bytes_requested;
+	}
+
+	return 0;
+}
+
+void spi_flash_en25_heatmap_reset(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	k_spinlock_key_t key;
+
+	for (uint32_t i = 0; i < heat_sectors(dev); i++) {
+		key = k_spin_lock(&data->heat_lock);
+		memset(&data->heat[i], 0, sizeof(data->heat[i]));
+		k_spin_unlock(&data->heat_lock, key);
+	}
+
+	key = k_spin_lock(&data->heat_lock);
+	data->heat_requested = 0;
+	data->heat_programmed = 0;
+	k_spin_unlock(&data->heat_lock, key);
+}
+#else
+static void heat_erased(const struct device *dev, off_t offset, size_t len) {}
+static void heat_programmed(const struct device *dev, off_t offset, size_t len) {}
+static void heat_requested(const struct device *dev, size_t len) {}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)
+static int io_submit(const struct device *dev, enum io_op op, off_t offset, void *buf, size_t len);
+#else
+static int io_submit(const struct device *dev, enum io_op op, off_t offset, void *buf, size_t len)
+{
+	return -ENOTSUP;
+}
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)
+static int qos_submit(const struct device *dev, enum io_op op, off_t offset, void *buf, size_t len);
+#else
+static int qos_submit(const struct device *dev, enum io_op op, off_t offset, void *buf, size_t len)
+{
+	return -ENOTSUP;
+}
+#endif
+
+/*
+ * Caller must hold the device lock.
+ */
+static int read_locked(const struct device *dev, off_t offset, void *data, size_t len)
+{
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_PREFETCH)
+	return prefetch_read(dev, offset, data, len);
+#else
+	return perform_read(dev, offset, data, len);
+#endif
+}
+
+static int spi_flash_en25_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	if (IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)) {
+		return io_submit(dev, IO_READ, offset, data, len);
+	}
+
+	if (IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)) {
+		return qos_submit(dev, IO_READ, offset, data, len);
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = read_locked(dev, offset, data, len);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+
+/*
+ * Sends a page program of @p len bytes taken from a list of buffers. Discarded sectors are not
+ * erased first, see start_write_bufs().
+ */
+static int send_page_program(const struct device *dev, off_t offset, const struct spi_buf *bufs,
+			     size_t count, size_t len)
+{
+	int err;
+
+	__ASSERT_NO_MSG(count <= MAX_DATA_BUFS);
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+	struct spi_buf bounced;
+
+	/* Gathered into one bounce buffer, which holds a whole write sector */
+	if (!bufs_dma_capable(bufs, count)) {
+		uint8_t *dst = get_dev_data(dev)->bounce_buf[0];
+
+		for (size_t i = 0; i < count; i++) {
+			memcpy(dst, bufs[i].buf, bufs[i].len);
+			dst += bufs[i].len;
+		}
+
+		bounced = (struct spi_buf){.buf = get_dev_data(dev)->bounce_buf[0], .len = len};
+		bufs = &bounced;
+		count = 1;
+	}
+#endif
+
+	region_programmed(dev, offset, len);
+
+	err = set_write_enable(dev);
+	if (err != 0) {
+		return err;
+	}
+
+	uint8_t const op_and_addr[] = {
+		CMD_PAGE_PROGRAM,
+		(offset >> 16) & 0xFF,
+		(offset >> 8) & 0xFF,
+		(offset >> 0) & 0xFF,
+	};
+	struct spi_buf tx_buf[1 + MAX_DATA_BUFS] = {{
+		.buf = (void *)&op_and_addr,
+		.len = sizeof(op_and_addr),
+	}};
+	const struct spi_buf_set tx_buf_set = {
+		.buffers = tx_buf,
+		.count = 1 + count,
+	};
+
+	memcpy(&tx_buf[1], bufs, count * sizeof(*bufs));
+
+	err = spi_write_dt(bus_for(dev, BUS_PROGRAM), &tx_buf_set);
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+		return -EIO;
+	}
+
+	heat_programmed(dev, offset, len);
+
+	return 0;
+}
+
+/*
+ * Issues a page program of consecutive bytes taken from a list of buffers, without waiting for it
+ * to complete. The buffers must not cross a write sector boundary.
+ */
+static int start_write_bufs(const struct device *dev, off_t offset, const struct spi_buf *bufs,
+			    size_t count)
+{
+	size_t len = 0;
+	int err;
+
+	for (size_t i = 0; i < count; i++) {
+		len += bufs[i].len;
+	}
+
+	err = discard_resolve(dev, offset, len);
+	if (err != 0) {
+		return err;
+	}
+
+	return send_page_program(dev, offset, bufs, count, len);
+}
+
+/*
+ * Issues a page program without waiting for it to complete.
+ */
+static int start_write(const struct device *dev, off_t offset, const void *data, size_t len)
+{
+	const struct spi_buf buf = {
+		.buf = (void *)data,
+		.len = len,
+	};
+
+	return start_write_bufs(dev, offset, &buf, 1);
+}
+
+static int perform_write(const struct device *dev, off_t offset, const void *data, size_t len)
+{
+	int err;
+
+	err = start_write(dev, offset, data, len);
+	if (err == 0) {
+		err = wait_until_ready(dev);
+	}
+
+	return (err != 0) ? -EIO : 0;
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+/*
+ * Length of the next bounced chunk, limited by the end of the write sector and the buffer size.
+ */
+static size_t bounce_chunk_len(const struct spi_flash_en25_config *cfg, off_t offset, size_t len)
+{
+	size_t page_left = WRITE_SECTOR_SIZE(cfg) - (offset & (WRITE_SECTOR_SIZE(cfg) - 1));
+
+	return MIN(MIN(len, page_left), CONFIG_SPI_FLASH_EN25_BOUNCE_SIZE);
+}
+
+/*
+ * Programs data the SPI controller cannot take directly. Each chunk is copied to a bounce buffer
+ * while the chip is still busy programming the previous one. Caller must hold the device lock.
+ */
+static int bounce_write_pages(const struct device *dev, off_t offset, const void *data,
+			      size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *dev_data = get_dev_data(dev);
+	const uint8_t *src = data;
+	size_t chunk_len = bounce_chunk_len(cfg, offset, len);
+	int cur = 0;
+	int err = 0;
+
+	memcpy(dev_data->bounce_buf[cur], src, chunk_len);
+
+	while (len) {
+		size_t next_len;
+
+		err = start_write(dev, offset, dev_data->bounce_buf[cur], chunk_len);
+		if (err != 0) {
+			break;
+		}
+
+		offset += chunk_len;
+		src += chunk_len;
+		len -= chunk_len;
+
+		next_len = bounce_chunk_len(cfg, offset, len);
+		memcpy(dev_data->bounce_buf[!cur], src, next_len);
+
+		err = wait_until_ready(dev);
+		if (err != 0) {
+			break;
+		}
+
+		chunk_len = next_len;
+		cur = !cur;
+	}
+
+	return (err != 0) ? -EIO : 0;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE) */
+
+/*
+ * Writes data page by page, never crossing a write sector boundary in a single page program.
+ * Caller must hold the device lock.
+ */
+static int write_pages(const struct device *dev, off_t offset, const void *data, size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err = 0;
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+	if (!dma_capable(data, len)) {
+		return bounce_write_pages(dev, offset, data, len);
+	}
+#endif
+
+	while (len) {
+		size_t chunk_len = len;
+		off_t current_page_start = offset - (offset & (WRITE_SECTOR_SIZE(cfg) - 1));
+		off_t current_page_end = current_page_start + WRITE_SECTOR_SIZE(cfg);
+
+		if (chunk_len > (current_page_end - offset)) {
+			chunk_len = (current_page_end - offset);
+		}
+
+		err = perform_write(dev, offset, data, chunk_len);
+		if (err != 0) {
+			break;
+		}
+
+		data = (uint8_t *)data + chunk_len;
+		offset += chunk_len;
+		len -= chunk_len;
+	}
+
+	return err;
+}
+
+static int spi_flash_en25_write(const struct device *dev, off_t offset, const void *data,
+				size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err = 0;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	heat_requested(dev, len);
+
+	if (IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)) {
+		return io_submit(dev, IO_WRITE, offset, (void *)data, len);
+	}
+
+	if (IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)) {
+		return qos_submit(dev, IO_WRITE, offset, (void *)data, len);
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = write_pages(dev, offset, data, len);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+
+/* For this will stayed commented out as we dont need it */
+// static int disable_block_protect(const struct device *dev)
+//{
+//     int err;
+//     err = set_write_enable(dev);
+//	if (err != 0) {
+//         return err;
+//     }
+//
+//	uint8_t const op_and_addr[] = {
+//         CMD_PAGE_PROGRAM,
+//		0b00111100,
+//	};
+//
+//	const struct spi_buf tx_buf[] = {
+//		{
+//			.buf = (void *)&op_and_addr,
+//			.len = sizeof(op_and_addr),
+//		}
+//	};
+//
+//	DEF_BUF_SET(tx_buf_set, tx_buf);
+//
+//	err = spi_write(get_dev_data(dev)->spi,
+//			&get_dev_config(dev)->spi_cfg,
+//			&tx_buf_set);
+//	if (err != 0) {
+//		LOG_ERR("SPI transaction failed with code: %d/%u",
+//			err, __LINE__);
+//	} else {
+//		err = wait_until_ready(dev);
+//	}
+//
+//	return (err != 0) ? -EIO : 0;
+// }
+
+static int perform_chip_erase(const struct device *dev)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err;
+
+	region_erasing(dev, 0, CHIP_SIZE(cfg));
+
+	err = set_write_enable(dev);
+	if (err != 0) {
+		return err;
+	}
+
+	uint8_t const chip_erase_cmd = CMD_CHIP_ERASE;
+	const struct spi_buf tx_buf[] = {{
+		.buf = (void *)&chip_erase_cmd,
+		.len = sizeof(chip_erase_cmd),
+	}};
+	DEF_BUF_SET(tx_buf_set, tx_buf);
+
+	err = spi_write_dt(bus_for(dev, BUS_PROGRAM), &tx_buf_set);
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+	} else {
+		heat_erased(dev, 0, CHIP_SIZE(cfg));
+		err = wait_until_ready(dev);
+		if (err == 0) {
+			region_erased(dev, 0, CHIP_SIZE(cfg));
+		}
+	}
+
+	return (err != 0) ? -EIO : 0;
+}
+
+/**
+ * @brief Check if erase can be performed at this offset with this size
+ *
+ * @param[in] entity_size The size of the erasable entity (block/sector of flash)
+ * @param[in] offset The current offset of the erase operation
+ * @param[in] requested_size The number of bytes to erase
+ *
+ * @retval true The requested erase operation can be performed
+ * @retval false The requested erase operation can NOT be performed
+ */
+static inline bool is_erase_possible(size_t entity_size, off_t offset, size_t requested_size)
+{
+	/* 1. The size we want to erase must be the same or larger then the entity size
+	 * 2. The offset must be a multiple of the requested entity size
+	 */
+	return (requested_size >= entity_size) && (((size_t)offset % entity_size) == 0);
+}
+
+static size_t erase_op_size(const struct spi_flash_en25_config *cfg, uint8_t opcode)
+{
+	switch (opcode) {
+	case CMD_FULL_BLOCK_ERASE:
+		return ERASE_FULL_BLOCK_SIZE(cfg);
+	case CMD_HALF_BLOCK_ERASE:
+		return ERASE_HALF_BLOCK_SIZE(cfg);
+	default:
+		return ERASE_SECTOR_SIZE(cfg);
+	}
+}
+
+static int perform_erase_op(const struct device *dev, uint8_t opcode, off_t offset)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err;
+
+	region_erasing(dev, offset, erase_op_size(cfg, opcode));
+
+	err = set_write_enable(dev);
+	if (err != 0) {
+		return err;
+	}
+
+	uint8_t const op_and_addr[] = {
+		opcode,
+		(offset >> 16) & 0xFF,
+		(offset >> 8) & 0xFF,
+		(offset >> 0) & 0xFF,
+	};
+	const struct spi_buf tx_buf[] = {{
+		.buf = (void *)&op_and_addr,
+		.len = sizeof(op_and_addr),
+	}};
+	DEF_BUF_SET(tx_buf_set, tx_buf);
+
+	err = spi_write_dt(bus_for(dev, BUS_PROGRAM), &tx_buf_set);
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+	} else {
+		heat_erased(dev, offset, erase_op_size(cfg, opcode));
+		err = wait_until_ready(dev);
+		if (err == 0) {
+			region_erased(dev, offset, erase_op_size(cfg, opcode));
+		}
+	}
+
+	return (err != 0) ? -EIO : 0;
+}
+
+/*
+ * Erases a sector aligned region using the largest erase commands possible.
+ * Caller must hold the device lock.
+ */
+static int erase_region(const struct device *dev, off_t offset, size_t size)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err = 0;
+
+	if (size == CHIP_SIZE(cfg)) {
+		return perform_chip_erase(dev);
+	}
+
+	while (size) {
+		/* Can we erase a full block? */
+		if (is_erase_possible(ERASE_FULL_BLOCK_SIZE(cfg), offset, size)) {
+			err = perform_erase_op(dev, CMD_FULL_BLOCK_ERASE, offset);
+			offset += ERASE_FULL_BLOCK_SIZE(cfg);
+			size -= ERASE_FULL_BLOCK_SIZE(cfg);
+		}
+		/* Can we erase a half block? */
+		else if (is_erase_possible(ERASE_HALF_BLOCK_SIZE(cfg), offset, size)) {
+			err = perform_erase_op(dev, CMD_HALF_BLOCK_ERASE, offset);
+			offset += ERASE_HALF_BLOCK_SIZE(cfg);
+			size -= ERASE_HALF_BLOCK_SIZE(cfg);
+		}
+		/* Can we erase a sector? */
+		else if (is_erase_possible(ERASE_SECTOR_SIZE(cfg), offset, size)) {
+			err = perform_erase_op(dev, CMD_SECTOR_ERASE, offset);
+			offset += ERASE_SECTOR_SIZE(cfg);
+			size -= ERASE_SECTOR_SIZE(cfg);
+		} else {
+			LOG_ERR("Unsupported erase request: "
+				"size %zu at 0x%lx",
+				size, (long)offset);
+			err = -EINVAL;
+		}
+
+		if (err != 0) {
+			break;
+		}
+	}
+
+	return err;
+}
+
+static int spi_flash_en25_erase(const struct device *dev, off_t offset, size_t size)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err = 0;
+
+	if (!is_valid_request(offset, size, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	/* Diagnose region errors before starting to erase. The offset is known to be positive. */
+	if ((((size_t)offset % ERASE_SECTOR_SIZE(cfg)) != 0) ||
+	    ((size % ERASE_SECTOR_SIZE(cfg)) != 0)) {
+		return -EINVAL;
+	}
+
+	if (IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)) {
+		return io_submit(dev, IO_ERASE, offset, NULL, size);
+	}
+
+	if (IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)) {
+		return qos_submit(dev, IO_ERASE, offset, NULL, size);
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = erase_region(dev, offset, size);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)
+struct io_request {
+	sys_dnode_t node;
+	enum io_op op;
+	off_t offset;
+	size_t len;
+	void *buf;
+	int result;
+	/* Number of requests dispatched ahead of this one while it was the oldest */
+	uint8_t bypassed;
+	struct k_sem done;
+};
+
+static off_t io_end(const struct io_request *req) { return req->offset + req->len; }
+
+/*
+ * A request may not be dispatched while an older request overlaps it, unless both are reads.
+ */
+static bool io_is_ready(sys_dlist_t *queue, const struct io_request *req)
+{
+	struct io_request *older;
+
+	SYS_DLIST_FOR_EACH_CONTAINER(queue, older, node) {
+		if (older == req) {
+			return true;
+		}
+
+		if ((older->op != IO_READ || req->op != IO_READ) && older->offset < io_end(req) &&
+		    req->offset < io_end(older)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Picks the next request in C-LOOK order starting from the last dispatched address, with reads
+ * and writes ahead of erases. The oldest request is served once it was bypassed too often.
+ */
+static struct io_request *io_pick(struct spi_flash_en25_data *data)
+{
+	struct io_request *oldest =
+		SYS_DLIST_PEEK_HEAD_CONTAINER(&data->io_queue, oldest, node);
+	struct io_request *best = NULL;
+	struct io_request *req;
+
+	if (oldest->bypassed >= CONFIG_SPI_FLASH_EN25_IO_QUEUE_MAX_BYPASS) {
+		return oldest;
+	}
+
+	SYS_DLIST_FOR_EACH_CONTAINER(&data->io_queue, req, node) {
+		if (!io_is_ready(&data->io_queue, req)) {
+			continue;
+		}
+
+		if (!best) {
+			best = req;
+			continue;
+		}
+
+		bool req_erase = req->op == IO_ERASE;
+		bool best_erase = best->op == IO_ERASE;
+		bool req_wrapped = req->offset < data->io_head;
+		bool best_wrapped = best->offset < data->io_head;
+
+		if (req_erase != best_erase) {
+			if (!req_erase) {
+				best = req;
+			}
+		} else if (req_wrapped != best_wrapped) {
+			if (!req_wrapped) {
+				best = req;
+			}
+		} else if (req->offset < best->offset) {
+			best = req;
+		}
+	}
+
+	if (best != oldest) {
+		oldest->bypassed++;
+	}
+
+	return best;
+}
+
+/*
+ * Collects ready requests that directly follow the first one in the batch. Reads are merged into
+ * one read command, writes only as long as they stay within the page of the first write.
+ */
+static size_t io_collect(const struct device *dev, struct io_request **batch)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	off_t page_end = batch[0]->offset - (batch[0]->offset & (WRITE_SECTOR_SIZE(cfg) - 1)) +
+			 WRITE_SECTOR_SIZE(cfg);
+	size_t count = 1;
+	struct io_request *req;
+	bool found = true;
+
+	if (batch[0]->op == IO_ERASE || (batch[0]->op == IO_WRITE && io_end(batch[0]) > page_end)) {
+		return count;
+	}
+
+	while (found && count < CONFIG_SPI_FLASH_EN25_IO_QUEUE_MAX_MERGE) {
+		found = false;
+
+		SYS_DLIST_FOR_EACH_CONTAINER(&data->io_queue, req, node) {
+			if (req->op != batch[0]->op || req->offset != io_end(batch[count - 1]) ||
+			    (req->op == IO_WRITE && io_end(req) > page_end) ||
+			    !io_is_ready(&data->io_queue, req)) {
+				continue;
+			}
+
+			batch[count++] = req;
+			found = true;
+			break;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Reads consecutive bytes into a list of buffers with the same prefetch handling read_locked()
+ * applies to a single buffer. Caller must hold the device lock.
+ */
+static int read_bufs_locked(const struct device *dev, off_t offset, const struct spi_buf *bufs,
+			    size_t count)
+{
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_PREFETCH)
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	off_t window_end = data->prefetch_start + data->prefetch_len;
+	size_t len = 0;
+	int err;
+
+	for (size_t i = 0; i < count; i++) {
+		len += bufs[i].len;
+	}
+
+	/* Reads the window can serve or should be refilled for go through it buffer by buffer */
+	if (!has_ext_mutex(dev) &&
+	    (offset == data->last_read_end ||
+	     (data->prefetch_len && offset >= data->prefetch_start && offset < window_end))) {
+		for (size_t i = 0; i < count; i++) {
+			err = prefetch_read(dev, offset, bufs[i].buf, bufs[i].len);
+			if (err != 0) {
+				return err;
+			}
+			offset += bufs[i].len;
+		}
+
+		return 0;
+	}
+
+	data->last_read_end = offset + len;
+#endif
+
+	return perform_read_bufs(dev, offset, bufs, count);
+}
+
+static int io_execute(const struct device *dev, struct io_request **batch, size_t count)
+{
+	struct spi_buf bufs[CONFIG_SPI_FLASH_EN25_IO_QUEUE_MAX_MERGE];
+	int err;
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		bufs[i].buf = batch[i]->buf;
+		bufs[i].len = batch[i]->len;
+	}
+
+	switch (batch[0]->op) {
+	case IO_READ:
+		if (count == 1) {
+			err = read_locked(dev, batch[0]->offset, batch[0]->buf, batch[0]->len);
+		} else {
+			err = read_bufs_locked(dev, batch[0]->offset, bufs, count);
+		}
+		break;
+	case IO_WRITE:
+		if (count == 1) {
+			err = write_pages(dev, batch[0]->offset, batch[0]->buf, batch[0]->len);
+			break;
+		}
+
+		err = start_write_bufs(dev, batch[0]->offset, bufs, count);
+		if (err == 0) {
+			err = wait_until_ready(dev);
+		}
+		err = (err != 0) ? -EIO : 0;
+		break;
+	default:
+		err = erase_region(dev, batch[0]->offset, batch[0]->len);
+		break;
+	}
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+
+static void io_thread_entry(void *p1, void *p2, void *p3)
+{
+	const struct device *dev = p1;
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	struct io_request *batch[CONFIG_SPI_FLASH_EN25_IO_QUEUE_MAX_MERGE];
+	k_spinlock_key_t key;
+	size_t count;
+	int err;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_sem_take(&data->io_doorbell, K_FOREVER);
+
+		while (true) {
+			key = k_spin_lock(&data->io_lock);
+
+			if (sys_dlist_is_empty(&data->io_queue)) {
+				k_spin_unlock(&data->io_lock, key);
+				break;
+			}
+
+			batch[0] = io_pick(data);
+			count = io_collect(dev, batch);
+
+			for (size_t i = 0; i < count; i++) {
+				sys_dlist_remove(&batch[i]->node);
+			}
+
+			k_spin_unlock(&data->io_lock, key);
+
+			err = io_execute(dev, batch, count);
+			data->io_head = io_end(batch[count - 1]);
+
+			for (size_t i = 0; i < count; i++) {
+				batch[i]->result = err;
+				k_sem_give(&batch[i]->done);
+			}
+		}
+	}
+}
+
+static int io_submit(const struct device *dev, enum io_op op, off_t offset, void *buf, size_t len)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	struct io_request req = {
+		.op = op,
+		.offset = offset,
+		.len = len,
+		.buf = buf,
+	};
+	k_spinlock_key_t key;
+
+	if (len == 0) {
+		return 0;
+	}
+
+	k_sem_init(&req.done, 0, 1);
+
+	key = k_spin_lock(&data->io_lock);
+	sys_dlist_append(&data->io_queue, &req.node);
+	k_spin_unlock(&data->io_lock, key);
+
+	k_sem_give(&data->io_doorbell);
+	k_sem_take(&req.done, K_FOREVER);
+
+	return req.result;
+}
+
+static void io_queue_init(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	sys_dlist_init(&data->io_queue);
+	k_sem_init(&data->io_doorbell, 0, 1);
+
+	k_thread_create(&data->io_thread, data->io_stack,
+			CONFIG_SPI_FLASH_EN25_IO_QUEUE_STACK_SIZE, io_thread_entry, (void *)dev,
+			NULL, NULL, CONFIG_SPI_FLASH_EN25_IO_QUEUE_THREAD_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&data->io_thread, dev->name);
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)
+static bool is_valid_qos_class(enum spi_flash_en25_qos_class cls)
+{
+	return (unsigned int)cls < SPI_FLASH_EN25_QOS_CLASS_COUNT;
+}
+
+/*
+ * Caller must hold the QoS mutex.
+ */
+static enum spi_flash_en25_qos_class qos_thread_class(struct spi_flash_en25_data *data,
+						      k_tid_t thread)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(data->qos_threads); i++) {
+		if (data->qos_threads[i].thread == thread) {
+			return data->qos_threads[i].cls;
+		}
+	}
+
+	return SPI_FLASH_EN25_QOS_NORMAL;
+}
+
+/*
+ * Splits requests so that other classes can get in between: reads at erase sector boundaries,
+ * writes at page boundaries and erases into single erase commands.
+ */
+static size_t qos_chunk_len(const struct spi_flash_en25_config *cfg, enum io_op op, off_t offset,
+			    size_t len)
+{
+	size_t unit;
+
+	switch (op) {
+	case IO_READ:
+		unit = ERASE_SECTOR_SIZE(cfg);
+		break;
+	case IO_WRITE:
+		unit = WRITE_SECTOR_SIZE(cfg);
+		break;
+	default:
+		if (len == CHIP_SIZE(cfg)) {
+			return len;
+		} else if (is_erase_possible(ERASE_FULL_BLOCK_SIZE(cfg), offset, len)) {
+			return ERASE_FULL_BLOCK_SIZE(cfg);
+		} else if (is_erase_possible(ERASE_HALF_BLOCK_SIZE(cfg), offset, len)) {
+			return ERASE_HALF_BLOCK_SIZE(cfg);
+		}
+		return ERASE_SECTOR_SIZE(cfg);
+	}
+
+	return MIN(len, unit - ((size_t)offset & (unit - 1)));
+}
+
+/*
+ * Refills a token bucket and returns how many milliseconds to wait until it holds @p cost.
+ * Buckets hold at most CONFIG_SPI_FLASH_EN25_QOS_BURST_MS worth of budget, but always enough for
+ * a single chunk.
+ */
+static uint32_t qos_bucket_wait(uint64_t *tokens, uint32_t rate, int64_t elapsed, uint64_t cost)
+{
+	uint64_t burst = MAX((uint64_t)rate * CONFIG_SPI_FLASH_EN25_QOS_BURST_MS, cost);
+
+	if (rate == 0) {
+		return 0;
+	}
+
+	*tokens = MIN(*tokens + (uint64_t)rate * elapsed, burst);
+	if (*tokens >= cost) {
+		return 0;
+	}
+
+	return DIV_ROUND_UP(cost - *tokens, rate);
+}
+
+/*
+ * Waits until the class has budget for the chunk, then takes it.
+ */
+static void qos_throttle(struct spi_flash_en25_data *data, enum spi_flash_en25_qos_class cls,
+			 size_t bytes)
+{
+	struct qos_class *qc = &data->qos[cls];
+	uint64_t byte_cost = (uint64_t)bytes * MSEC_PER_SEC;
+	uint64_t op_cost = MSEC_PER_SEC;
+	uint32_t wait_ms;
+
+	k_mutex_lock(&data->qos_mutex, K_FOREVER);
+
+	while (true) {
+		int64_t now = k_uptime_get();
+		int64_t elapsed = now - qc->last_refill;
+
+		qc->last_refill = now;
+		wait_ms = MAX(qos_bucket_wait(&qc->byte_tokens, qc->byte_rate, elapsed, byte_cost),
+			      qos_bucket_wait(&qc->op_tokens, qc->op_rate, elapsed, op_cost));
+		if (wait_ms == 0) {
+			break;
+		}
+
+		qc->stats.throttled_ms += wait_ms;
+		k_mutex_unlock(&data->qos_mutex);
+		k_sleep(K_MSEC(wait_ms));
+		k_mutex_lock(&data->qos_mutex, K_FOREVER);
+	}
+
+	if (qc->byte_rate) {
+		qc->byte_tokens -= byte_cost;
+	}
+	if (qc->op_rate) {
+		qc->op_tokens -= op_cost;
+	}
+
+	k_mutex_unlock(&data->qos_mutex);
+}
+
+/*
+ * Takes the device for a class. Waits while the device is busy or a higher priority class is
+ * waiting for it.
+ */
+static void qos_gate_take(struct spi_flash_en25_data *data, enum spi_flash_en25_qos_class cls)
+{
+	k_mutex_lock(&data->qos_mutex, K_FOREVER);
+
+	data->qos_waiting[cls]++;
+
+	while (true) {
+		bool higher_waiting = false;
+
+		for (int i = 0; i < cls; i++) {
+			higher_waiting |= data->qos_waiting[i] != 0;
+		}
+
+		if (!data->qos_busy && !higher_waiting) {
+			break;
+		}
+
+		k_condvar_wait(&data->qos_cond, &data->qos_mutex, K_FOREVER);
+	}
+
+	data->qos_waiting[cls]--;
+	data->qos_busy = true;
+
+	k_mutex_unlock(&data->qos_mutex);
+}
+
+static void qos_gate_give(struct spi_flash_en25_data *data, enum spi_flash_en25_qos_class cls,
+			  size_t bytes, uint32_t wait_us)
+{
+	struct spi_flash_en25_qos_stats *stats = &data->qos[cls].stats;
+
+	k_mutex_lock(&data->qos_mutex, K_FOREVER);
+
+	data->qos_busy = false;
+	stats->ops++;
+	stats->bytes += bytes;
+	stats->total_wait_us += wait_us;
+	stats->max_wait_us = MAX(stats->max_wait_us, wait_us);
+
+	k_condvar_broadcast(&data->qos_cond);
+	k_mutex_unlock(&data->qos_mutex);
+}
+
+static int qos_submit(const struct device *dev, enum io_op op, off_t offset, void *buf, size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	enum spi_flash_en25_qos_class cls;
+	int err = 0;
+
+	k_mutex_lock(&data->qos_mutex, K_FOREVER);
+	cls = qos_thread_class(data, k_current_get());
+	k_mutex_unlock(&data->qos_mutex);
+
+	while (len && err == 0) {
+		size_t chunk_len = qos_chunk_len(cfg, op, offset, len);
+		size_t bytes = (op == IO_ERASE) ? 0 : chunk_len;
+
+		/* Erases only use the operation budget */
+		qos_throttle(data, cls, bytes);
+
+		uint32_t start = k_cycle_get_32();
+
+		qos_gate_take(data, cls);
+
+		uint32_t wait_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+		err = lock_device(dev);
+		if (err == 0) {
+			switch (op) {
+			case IO_READ:
+				err = read_locked(dev, offset, buf, chunk_len);
+				break;
+			case IO_WRITE:
+				err = write_pages(dev, offset, buf, chunk_len);
+				break;
+			default:
+				err = erase_region(dev, offset, chunk_len);
+				break;
+			}
+
+			int m_err = unlock_device(dev);
+			if (m_err) {
+				err = m_err;
+			}
+		}
+
+		qos_gate_give(data, cls, bytes, wait_us);
+
+		if (buf) {
+			buf = (uint8_t *)buf + chunk_len;
+		}
+		offset += chunk_len;
+		len -= chunk_len;
+	}
+
+	return err;
+}
+
+int spi_flash_en25_qos_attach(const struct device *dev, k_tid_t thread,
+			      enum spi_flash_en25_qos_class cls)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	int err = -ENOMEM;
+
+	if (!is_valid_qos_class(cls)) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&data->qos_mutex, K_FOREVER);
+
+	/* Drop an existing entry first, the normal class does not need one */
+	for (size_t i = 0; i < ARRAY_SIZE(data->qos_threads); i++) {
+		if (data->qos_threads[i].thread == thread) {
+			data->qos_threads[i].thread = NULL;
+		}
+	}
+
+	if (cls == SPI_FLASH_EN25_QOS_NORMAL) {
+		err = 0;
+	} else {
+		for (size_t i = 0; i < ARRAY_SIZE(data->qos_threads); i++) {
+			if (data->qos_threads[i].thread == NULL) {
+				data->qos_threads[i].thread = thread;
+				data->qos_threads[i].cls = cls;
+				err = 0;
+				break;
+			}
+		}
+	}
+
+	k_mutex_unlock(&data->qos_mutex);
+
+	return err;
+}
+
+int spi_flash_en25_qos_set_budget(const struct device *dev, enum spi_flash_en25_qos_class cls,
+				  uint32_t bytes_per_sec, uint32_t ops_per_sec)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	struct qos_class *qc;
+
+	if (!is_valid_qos_class(cls)) {
+		return -EINVAL;
+	}
+
+	qc = &data->qos[cls];
+
+	k_mutex_lock(&data->qos_mutex, K_FOREVER);
+
+	qc->byte_rate = bytes_per_sec;
+	qc->op_rate = ops_per_sec;
+	/* Start with a full burst */
+	qc->byte_tokens = (uint64_t)bytes_per_sec * CONFIG_SPI_FLASH_EN25_QOS_BURST_MS;
+	qc->op_tokens = (uint64_t)ops_per_sec * CONFIG_SPI_FLASH_EN25_QOS_BURST_MS;
+	qc->last_refill = k_uptime_get();
+
+	k_mutex_unlock(&data->qos_mutex);
+
+	return 0;
+}
+
+int spi_flash_en25_qos_get_stats(const struct device *dev, enum spi_flash_en25_qos_class cls,
+				 struct spi_flash_en25_qos_stats *stats, bool reset)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	if (!is_valid_qos_class(cls)) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&data->qos_mutex, K_FOREVER);
+
+	*stats = data->qos[cls].stats;
+	if (reset) {
+		memset(&data->qos[cls].stats, 0, sizeof(data->qos[cls].stats));
+	}
+
+	k_mutex_unlock(&data->qos_mutex);
+
+	return 0;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BORROW)
+int spi_flash_en25_read_borrow(const struct device *dev, off_t offset, size_t len,
+			       const void **data, k_timeout_t timeout)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *dev_data = get_dev_data(dev);
+	struct borrow_slot *slot = NULL;
+	int err;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	if (len == 0 || len > CONFIG_SPI_FLASH_EN25_BORROW_MAX_LEN) {
+		return -EINVAL;
+	}
+
+	if (k_sem_take(&dev_data->borrow_free, timeout) != 0) {
+		return -ENOMEM;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		k_sem_give(&dev_data->borrow_free);
+		return m_err;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(dev_data->borrow); i++) {
+		if (!dev_data->borrow[i].in_use) {
+			slot = &dev_data->borrow[i];
+			break;
+		}
+	}
+
+	__ASSERT(slot, "No free borrow slot");
+
+	err = read_locked(dev, offset, slot->buf, len);
+	if (err == 0) {
+		slot->offset = offset;
+		slot->len = len;
+		slot->stale = false;
+		slot->in_use = true;
+		*data = slot->buf;
+	}
+
+	m_err = unlock_device(dev);
+
+	if (err != 0) {
+		k_sem_give(&dev_data->borrow_free);
+		return err;
+	}
+
+	return m_err;
+}
+
+int spi_flash_en25_read_release(const struct device *dev, const void *data)
+{
+	struct spi_flash_en25_data *dev_data = get_dev_data(dev);
+	int err = -EINVAL;
+
+	/* Only the slot state is touched, so the external mutex is not needed */
+	acquire(dev);
+
+	for (size_t i = 0; i < ARRAY_SIZE(dev_data->borrow); i++) {
+		struct borrow_slot *slot = &dev_data->borrow[i];
+
+		if (slot->in_use && slot->buf == data) {
+			err = slot->stale ? -ESTALE : 0;
+			slot->in_use = false;
+			k_sem_give(&dev_data->borrow_free);
+			break;
+		}
+	}
+
+	release(dev);
+
+	return err;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BORROW) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_POWER_STATS)
+int spi_flash_en25_power_stats_get(const struct device *dev,
+				   struct spi_flash_en25_power_stats *stats, bool reset)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	/* Sum of current times time, in microamperes times microseconds */
+	uint64_t charge = 0;
+
+	acquire(dev);
+
+	/* Account the time spent in the current state so far */
+	(void)power_set(dev, data->power.state);
+
+	for (int i = 0; i < SPI_FLASH_EN25_POWER_STATE_COUNT; i++) {
+		stats->residency_us[i] = k_ticks_to_us_floor64(data->power.ticks[i]);
+		charge += (uint64_t)cfg->current_ua[i] * stats->residency_us[i];
+	}
+
+	stats->wake_count = data->power.wake_count;
+	stats->max_wake_latency_us = data->power.max_wake_latency_us;
+	stats->total_wake_latency_us = data->power.total_wake_latency_us;
+	stats->charge_uc = charge / USEC_PER_SEC;
+	stats->energy_uj = (charge / USEC_PER_SEC) * cfg->supply_mv / MSEC_PER_SEC;
+
+	if (reset) {
+		memset(data->power.ticks, 0, sizeof(data->power.ticks));
+		data->power.wake_count = 0;
+		data->power.max_wake_latency_us = 0;
+		data->power.total_wake_latency_us = 0;
+	}
+
+	release(dev);
+
+	return 0;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_POWER_STATS) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_UPDATE)
+
+#define INST_SECTOR_BUF_MEMBER(inst) uint8_t inst_##inst[DT_INST_PROP(inst, erase_sector_size)];
+
+/* Sized to fit the largest erase sector of all instances. Shared between instances, so it is
+ * protected by its own lock, which is always taken after the device lock. */
+static union {
+	DT_INST_FOREACH_STATUS_OKAY(INST_SECTOR_BUF_MEMBER)
+} update_buf;
+static K_SEM_DEFINE(update_buf_lock, 1, 1);
+
+/*
+ * Updates a region that lies within a single erase sector. Caller must hold the device lock and
+ * the update buffer lock.
+ */
+static int update_sector(const struct device *dev, off_t offset, const uint8_t *data, size_t len,
+			 enum spi_flash_en25_update_path *path)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	uint8_t *buf = (uint8_t *)&update_buf;
+	off_t sector_start = offset - (offset % ERASE_SECTOR_SIZE(cfg));
+	size_t head_len = offset - sector_start;
+	size_t tail_len = ERASE_SECTOR_SIZE(cfg) - head_len - len;
+	size_t first_diff = len;
+	size_t last_diff = 0;
+	bool programmable = true;
+	int err;
+
+	/*
+	 * Programming only the differing span would erase the unchanged bytes with the rest of a
+	 * discarded sector, so all of the data is written.
+	 */
+	if (discard_pending(dev, offset)) {
+		*path = SPI_FLASH_EN25_UPDATE_ERASED;
+		return write_pages(dev, offset, data, len);
+	}
+
+	err = perform_read(dev, offset, buf + head_len, len);
+	if (err != 0) {
+		return err;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		uint8_t old = buf[head_len + i];
+
+		if (old == data[i]) {
+			continue;
+		}
+		if ((old & data[i]) != data[i]) {
+			programmable = false;
+		}
+		first_diff = MIN(first_diff, i);
+		last_diff = i;
+	}
+
+	if (first_diff == len) {
+		*path = SPI_FLASH_EN25_UPDATE_UNCHANGED;
+		return 0;
+	}
+
+	if (programmable) {
+		/* Only program the bytes that actually differ */
+		*path = SPI_FLASH_EN25_UPDATE_IN_PLACE;
+		return write_pages(dev, offset + first_diff, data + first_diff,
+				   last_diff - first_diff + 1);
+	}
+
+	*path = SPI_FLASH_EN25_UPDATE_ERASED;
+
+	/* Fetch the rest of the sector, the updated region is already in the buffer */
+	if (head_len) {
+		err = perform_read(dev, sector_start, buf, head_len);
+		if (err != 0) {
+			return err;
+		}
+	}
+	if (tail_len) {
+		err = perform_read(dev, offset + len, buf + head_len + len, tail_len);
+		if (err != 0) {
+			return err;
+		}
+	}
+	memcpy(buf + head_len, data, len);
+
+	err = perform_erase_op(dev, CMD_SECTOR_ERASE, sector_start);
+	if (err != 0) {
+		return err;
+	}
+
+	/* Write back only the pages that are not left in the erased state */
+	for (size_t page = 0; page < ERASE_SECTOR_SIZE(cfg); page += WRITE_SECTOR_SIZE(cfg)) {
+		bool erased = true;
+
+		for (size_t i = 0; i < WRITE_SECTOR_SIZE(cfg); i++) {
+			if (buf[page + i] != flash_en25_parameters.erase_value) {
+				erased = false;
+				break;
+			}
+		}
+		if (erased) {
+			continue;
+		}
+
+		err = perform_write(dev, sector_start + page, buf + page, WRITE_SECTOR_SIZE(cfg));
+		if (err != 0) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+int spi_flash_en25_update(const struct device *dev, off_t offset, const void *data, size_t len,
+			  enum spi_flash_en25_update_path *path)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	enum spi_flash_en25_update_path taken = SPI_FLASH_EN25_UPDATE_UNCHANGED;
+	int err = 0;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	k_sem_take(&update_buf_lock, K_FOREVER);
+
+	while (len) {
+		enum spi_flash_en25_update_path sector_path;
+		off_t sector_end = offset - (offset % ERASE_SECTOR_SIZE(cfg)) +
+				   ERASE_SECTOR_SIZE(cfg);
+		size_t chunk_len = MIN(len, sector_end - offset);
+
+		err = update_sector(dev, offset, data, chunk_len, &sector_path);
+		if (err != 0) {
+			break;
+		}
+		taken = MAX(taken, sector_path);
+
+		data = (const uint8_t *)data + chunk_len;
+		offset += chunk_len;
+		len -= chunk_len;
+	}
+
+	k_sem_give(&update_buf_lock);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	if (path) {
+		*path = taken;
+	}
+
+	return err;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_UPDATE) */
+
+#if STREAM_READ_ENABLED
+/*
+ * Called for every chunk of a streamed read. Returning a positive value stops the stream without
+ * an error, a negative value aborts it with that error.
+ */
+typedef int (*stream_cb_t)(const struct device *dev, off_t offset, const uint8_t *chunk,
+			   size_t len, void *user_data);
+
+/*
+ * Source of the buffers a region is streamed through. get() returns the buffer for the next chunk,
+ * or NULL if none became available. put() takes back a buffer that was not handed to the
+ * callback, it may be NULL if buffers are not claimed.
+ */
+struct stream_src {
+	uint8_t *(*get)(struct stream_src *src);
+	void (*put)(struct stream_src *src, uint8_t *buf);
+	size_t buf_len;
+};
+
+static void stream_src_put(struct stream_src *src, uint8_t *buf)
+{
+	if (src->put) {
+		src->put(src, buf);
+	}
+}
+
+#if IS_ENABLED(CONFIG_SPI_ASYNC)
+struct async_read {
+	uint8_t op_and_addr[4];
+	struct spi_buf tx_buf[1];
+	struct spi_buf rx_buf[2];
+	struct spi_buf_set tx_buf_set;
+	struct spi_buf_set rx_buf_set;
+	struct k_poll_signal signal;
+};
+
+/*
+ * Starts a read that completes in the background. The transfer descriptors live in @p req, which
+ * must stay valid until async_read_wait() returns.
+ */
+static int async_read_start(const struct device *dev, struct async_read *req, off_t offset,
+			    void *data, size_t len)
+{
+	const struct spi_dt_spec *bus = bus_for(dev, BUS_READ);
+	int err;
+
+	req->op_and_addr[0] = CMD_READ;
+	req->op_and_addr[1] = (offset >> 16) & 0xFF;
+	req->op_and_addr[2] = (offset >> 8) & 0xFF;
+	req->op_and_addr[3] = (offset >> 0) & 0xFF;
+	req->tx_buf[0] = (struct spi_buf){.buf = req->op_and_addr, .len = sizeof(req->op_and_addr)};
+	req->rx_buf[0] = (struct spi_buf){.buf = NULL, .len = sizeof(req->op_and_addr)};
+	req->rx_buf[1] = (struct spi_buf){.buf = data, .len = len};
+	req->tx_buf_set = (struct spi_buf_set){.buffers = req->tx_buf, .count = 1};
+	req->rx_buf_set = (struct spi_buf_set){.buffers = req->rx_buf, .count = 2};
+	k_poll_signal_init(&req->signal);
+
+	err = spi_transceive_signal(bus->bus, &bus->config, &req->tx_buf_set,
+				    &req->rx_buf_set, &req->signal);
+	if (err != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int async_read_wait(struct async_read *req)
+{
+	struct k_poll_event event =
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &req->signal);
+	unsigned int signaled;
+	int result;
+
+	k_poll(&event, 1, K_FOREVER);
+	k_poll_signal_check(&req->signal, &signaled, &result);
+	if (result != 0) {
+		LOG_ERR("SPI transaction failed with code: %d/%u", result, __LINE__);
+		return -EIO;
+	}
+
+	return 0;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_ASYNC) */
+
+/*
+ * Reads a region in chunks into buffers taken from @p src and passes every chunk to the callback.
+ * With asynchronous SPI the next chunk is already being transferred while the callback processes
+ * the previous one. Caller must hold the device lock.
+ */
+static int stream_range_bufs(const struct device *dev, struct stream_src *src, off_t offset,
+			     size_t len, stream_cb_t cb, void *user_data)
+{
+	size_t chunk_len = MIN(len, src->buf_len);
+	uint8_t *cur;
+	int err;
+
+	if (!len) {
+		return 0;
+	}
+
+	cur = src->get(src);
+	if (!cur) {
+		return -EAGAIN;
+	}
+
+	err = perform_read(dev, offset, cur, chunk_len);
+	if (err != 0) {
+		stream_src_put(src, cur);
+		return err;
+	}
+
+	while (len) {
+		off_t next_offset = offset + chunk_len;
+		size_t next_len = MIN(len - chunk_len, src->buf_len);
+		uint8_t *next = NULL;
+		int cb_ret;
+
+#if IS_ENABLED(CONFIG_SPI_ASYNC)
+		struct async_read req;
+
+		if (next_len) {
+			next = src->get(src);
+			if (!next) {
+				stream_src_put(src, cur);
+				return -EAGAIN;
+			}
+
+			err = async_read_start(dev, &req, next_offset, next, next_len);
+			if (err != 0) {
+				stream_src_put(src, next);
+				stream_src_put(src, cur);
+				return err;
+			}
+		}
+
+		cb_ret = cb(dev, offset, cur, chunk_len, user_data);
+
+		/* The transfer has to finish before we leave, even if the stream is stopped */
+		if (next_len) {
+			err = async_read_wait(&req);
+		}
+#else
+		cb_ret = cb(dev, offset, cur, chunk_len, user_data);
+
+		if (next_len && cb_ret == 0) {
+			next = src->get(src);
+			if (!next) {
+				return -EAGAIN;
+			}
+
+			err = perform_read(dev, next_offset, next, next_len);
+		}
+#endif
+		if (cb_ret != 0 || err != 0) {
+			if (next) {
+				stream_src_put(src, next);
+			}
+
+			if (cb_ret != 0) {
+				return (cb_ret < 0) ? cb_ret : 0;
+			}
+
+			return err;
+		}
+
+		len -= chunk_len;
+		offset = next_offset;
+		chunk_len = next_len;
+		cur = next;
+	}
+
+	return 0;
+}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_STREAM) || IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+/* Two driver owned buffers used in turn, which are free again once the callback returns */
+struct stream_pair {
+	struct stream_src src;
+	uint8_t *const *bufs;
+	int next;
+};
+
+static uint8_t *stream_pair_get(struct stream_src *src)
+{
+	struct stream_pair *pair = CONTAINER_OF(src, struct stream_pair, src);
+	uint8_t *buf = pair->bufs[pair->next];
+
+	pair->next = !pair->next;
+
+	return buf;
+}
+
+/*
+ * Streams a region through two driver owned buffers of @p buf_len bytes. Caller must hold the
+ * device lock.
+ */
+static int stream_range_pair(const struct device *dev, uint8_t *const bufs[2], size_t buf_len,
+			     off_t offset, size_t len, stream_cb_t cb, void *user_data)
+{
+	struct stream_pair pair = {
+		.src = {.get = stream_pair_get, .buf_len = buf_len},
+		.bufs = bufs,
+	};
+
+	return stream_range_bufs(dev, &pair.src, offset, len, cb, user_data);
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_STREAM) || IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE) */
+#endif /* STREAM_READ_ENABLED */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_STREAM)
+/*
+ * Streams a region through the stream buffers. Caller must hold the device lock.
+ */
+static int stream_range(const struct device *dev, off_t offset, size_t len, stream_cb_t cb,
+			void *user_data)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	uint8_t *const bufs[] = {data->stream_buf[0], data->stream_buf[1]};
+
+	return stream_range_pair(dev, bufs, CONFIG_SPI_FLASH_EN25_STREAM_CHUNK_SIZE, offset, len,
+				 cb, user_data);
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_STREAM) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE)
+static int bounce_copy_chunk(const struct device *dev, off_t offset, const uint8_t *chunk,
+			     size_t len, void *user_data)
+{
+	uint8_t **dst = user_data;
+
+	memcpy(*dst, chunk, len);
+	*dst += len;
+
+	return 0;
+}
+
+/*
+ * Reads into a buffer the SPI controller cannot use directly, through the bounce buffers. The
+ * next chunk is transferred while the previous one is copied out. Caller must hold the device
+ * lock.
+ */
+static int bounce_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+	struct spi_flash_en25_data *dev_data = get_dev_data(dev);
+	uint8_t *const bufs[] = {dev_data->bounce_buf[0], dev_data->bounce_buf[1]};
+	uint8_t *dst = data;
+
+	return stream_range_pair(dev, bufs, CONFIG_SPI_FLASH_EN25_BOUNCE_SIZE, offset, len,
+				 bounce_copy_chunk, &dst);
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BULK_READ)
+/*
+ * Claims a free bulk read buffer. When the consumer holds all of them this waits for one to be
+ * released, which is what throttles the reads to the pace of the consumer.
+ */
+static uint8_t *bulk_buf_take(struct spi_flash_en25_data *data, k_timeout_t timeout)
+{
+	if (k_sem_take(&data->bulk_free, timeout) != 0) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(data->bulk_buf); i++) {
+		if (!atomic_test_and_set_bit(&data->bulk_held, i)) {
+			return data->bulk_buf[i];
+		}
+	}
+
+	__ASSERT(false, "No free bulk read buffer");
+
+	return NULL;
+}
+
+static int bulk_buf_give(struct spi_flash_en25_data *data, const void *buf)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(data->bulk_buf); i++) {
+		if (data->bulk_buf[i] != buf) {
+			continue;
+		}
+
+		if (!atomic_test_and_clear_bit(&data->bulk_held, i)) {
+			return -EINVAL;
+		}
+
+		k_sem_give(&data->bulk_free);
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+/* The bulk read buffers, a chunk handed to the callback is owned by the consumer */
+struct bulk_src {
+	struct stream_src src;
+	struct spi_flash_en25_data *data;
+	k_timeout_t timeout;
+};
+
+static uint8_t *bulk_src_get(struct stream_src *src)
+{
+	struct bulk_src *bulk = CONTAINER_OF(src, struct bulk_src, src);
+
+	return bulk_buf_take(bulk->data, bulk->timeout);
+}
+
+static void bulk_src_put(struct stream_src *src, uint8_t *buf)
+{
+	(void)bulk_buf_give(CONTAINER_OF(src, struct bulk_src, src)->data, buf);
+}
+
+int spi_flash_en25_bulk_read(const struct device *dev, off_t offset, size_t len,
+			     spi_flash_en25_bulk_read_cb_t cb, void *user_data, k_timeout_t timeout)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct bulk_src bulk = {
+		.src = {
+			.get = bulk_src_get,
+			.put = bulk_src_put,
+			.buf_len = CONFIG_SPI_FLASH_EN25_BULK_READ_CHUNK_SIZE,
+		},
+		.data = get_dev_data(dev),
+		.timeout = timeout,
+	};
+	int err;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	/* The wait for the consumer holds the device, so it has to be bounded */
+	if (!cb || K_TIMEOUT_EQ(timeout, K_FOREVER)) {
+		return -EINVAL;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = stream_range_bufs(dev, &bulk.src, offset, len, cb, user_data);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+
+int spi_flash_en25_bulk_read_release(const struct device *dev, const void *chunk)
+{
+	/* Only atomics and a semaphore are touched, so this is safe to call from an ISR */
+	return bulk_buf_give(get_dev_data(dev), chunk);
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BULK_READ) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DIGEST)
+struct digest_ctx {
+	spi_flash_en25_digest_cb_t update;
+	void *user_data;
+};
+
+static int digest_chunk(const struct device *dev, off_t offset, const uint8_t *chunk, size_t len,
+			void *user_data)
+{
+	struct digest_ctx *ctx = user_data;
+	int err = ctx->update(chunk, len, ctx->user_data);
+
+	/* Early stop is not supported, treat everything but 0 as an error */
+	return (err > 0) ? -EIO : err;
+}
+
+int spi_flash_en25_digest(const struct device *dev, off_t offset, size_t len,
+			  spi_flash_en25_digest_cb_t update, void *user_data)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct digest_ctx ctx = {
+		.update = update,
+		.user_data = user_data,
+	};
+	int err;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = stream_range(dev, offset, len, digest_chunk, &ctx);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+
+static int crc32_update(const uint8_t *data, size_t len, void *user_data)
+{
+	uint32_t *crc = user_data;
+
+	*crc = crc32_ieee_update(*crc, data, len);
+	return 0;
+}
+
+int spi_flash_en25_crc32(const struct device *dev, off_t offset, size_t len, uint32_t *crc)
+{
+	return spi_flash_en25_digest(dev, offset, len, crc32_update, crc);
+}
+
+#if IS_ENABLED(CONFIG_TINYCRYPT_SHA256)
+static int sha256_update(const uint8_t *data, size_t len, void *user_data)
+{
+	struct tc_sha256_state_struct *state = user_data;
+
+	return (tc_sha256_update(state, data, len) == TC_CRYPTO_SUCCESS) ? 0 : -EINVAL;
+}
+
+int spi_flash_en25_sha256(const struct device *dev, off_t offset, size_t len, uint8_t *hash)
+{
+	struct tc_sha256_state_struct state;
+	int err;
+
+	(void)tc_sha256_init(&state);
+
+	err = spi_flash_en25_digest(dev, offset, len, sha256_update, &state);
+	if (err != 0) {
+		return err;
+	}
+
+	return (tc_sha256_final(hash, &state) == TC_CRYPTO_SUCCESS) ? 0 : -EINVAL;
+}
+#endif /* IS_ENABLED(CONFIG_TINYCRYPT_SHA256) */
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_DIGEST) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_WRITE_VERIFY)
+
+#define INST_PAGE_BUF_MEMBER(inst) uint8_t inst_##inst[DT_INST_PROP(inst, write_sector_size)];
+
+int spi_flash_en25_write_verify(const struct device *dev, off_t offset, const void *data,
+				size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	union {
+		DT_INST_FOREACH_STATUS_OKAY(INST_PAGE_BUF_MEMBER)
+	} verify_buf;
+	int err = 0;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	while (len) {
+		size_t chunk_len = len;
+		off_t current_page_start = offset - (offset & (WRITE_SECTOR_SIZE(cfg) - 1));
+		off_t current_page_end = current_page_start + WRITE_SECTOR_SIZE(cfg);
+
+		if (chunk_len > (current_page_end - offset)) {
+			chunk_len = (current_page_end - offset);
+		}
+
+		err = perform_write(dev, offset, data, chunk_len);
+		if (err != 0) {
+			break;
+		}
+
+		err = perform_read(dev, offset, &verify_buf, chunk_len);
+		if (err != 0) {
+			break;
+		}
+
+		if (memcmp(&verify_buf, data, chunk_len) != 0) {
+			LOG_ERR("Verify failed for page at 0x%lx", (long)current_page_start);
+			err = -EIO;
+			break;
+		}
+
+		data = (uint8_t *)data + chunk_len;
+		offset += chunk_len;
+		len -= chunk_len;
+	}
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_WRITE_VERIFY) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_COPY)
+/*
+ * Programs a buffer page by page, polling for completion without sleeping. Caller must hold the
+ * device lock.
+ */
+static int program_pages_polled(const struct device *dev, off_t offset, const uint8_t *data,
+				size_t len)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err = 0;
+
+	while (len) {
+		off_t current_page_end = offset - (offset & (WRITE_SECTOR_SIZE(cfg) - 1)) +
+					 WRITE_SECTOR_SIZE(cfg);
+		size_t chunk_len = MIN(len, current_page_end - offset);
+
+		err = start_write(dev, offset, data, chunk_len);
+		if (err != 0) {
+			break;
+		}
+
+		err = poll_until_ready(dev, CONFIG_SPI_FLASH_EN25_COPY_POLL_INTERVAL_US,
+				       PAGE_PROGRAM_TIMEOUT_US);
+		if (err != 0) {
+			break;
+		}
+
+		data += chunk_len;
+		offset += chunk_len;
+		len -= chunk_len;
+	}
+
+	return err;
+}
+
+int spi_flash_en25_copy(const struct device *dev, off_t src, off_t dst, size_t len, bool erase_dst)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	int err = 0;
+
+	if (!is_valid_request(src, len, CHIP_SIZE(cfg)) ||
+	    !is_valid_request(dst, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	/* Overlapping regions would read back data that was already copied */
+	if (src < dst + (off_t)len && dst < src + (off_t)len) {
+		return -EINVAL;
+	}
+
+	if (erase_dst &&
+	    (((dst % ERASE_SECTOR_SIZE(cfg)) != 0) || ((len % ERASE_SECTOR_SIZE(cfg)) != 0))) {
+		return -EINVAL;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	if (erase_dst) {
+		err = erase_region(dev, dst, len);
+	}
+
+	while (len && err == 0) {
+		/* Chunks end at a destination page boundary, so no page is programmed twice */
+		size_t chunk_len = MIN(len, sizeof(data->stream_buf[0]));
+		size_t overhang = (dst + chunk_len) & (WRITE_SECTOR_SIZE(cfg) - 1);
+
+		if (chunk_len < len && overhang < chunk_len) {
+			chunk_len -= overhang;
+		}
+
+		/* The flash can not be read while a page program is in progress, so a whole chunk
+		 * is fetched in one transfer and its pages are then programmed back to back.
+		 */
+		err = perform_read(dev, src, data->stream_buf[0], chunk_len);
+		if (err != 0) {
+			break;
+		}
+
+		err = program_pages_polled(dev, dst, data->stream_buf[0], chunk_len);
+
+		src += chunk_len;
+		dst += chunk_len;
+		len -= chunk_len;
+	}
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	return err;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_COPY) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK)
+struct blank_scan {
+	/* Offset of the first match, -1 while nothing is found */
+	off_t found;
+	/* Size of the blank unit to look for, 0 when looking for a non-blank byte */
+	size_t unit;
+	/* Units are aligned relative to the start of the scanned region */
+	off_t region_start;
+	bool unit_dirty;
+	/* Where the erase sector being scanned was entered, and whether it holds data */
+	off_t sector_start;
+	bool sector_dirty;
+};
+
+/*
+ * Returns a pointer to the first byte that is not erased, or NULL if all bytes are erased. The
+ * bulk of the buffer is compared a machine word at a time.
+ */
+static const uint8_t *find_not_erased(const uint8_t *buf, size_t len)
+{
+	const uint8_t erase_value = flash_en25_parameters.erase_value;
+	const unsigned long erased_word = (~0UL / 0xFF) * erase_value;
+	const uint8_t *end = buf + len;
+
+	while (buf < end && ((uintptr_t)buf % sizeof(unsigned long)) != 0) {
+		if (*buf != erase_value) {
+			return buf;
+		}
+		buf++;
+	}
+
+	while ((size_t)(end - buf) >= sizeof(unsigned long) &&
+	       *(const unsigned long *)buf == erased_word) {
+		buf += sizeof(unsigned long);
+	}
+
+	/* Either the tail or the word that did not match */
+	while (buf < end) {
+		if (*buf != erase_value) {
+			return buf;
+		}
+		buf++;
+	}
+
+	return NULL;
+}
+
+static int find_non_blank_chunk(const struct device *dev, off_t offset, const uint8_t *chunk,
+				size_t len, void *user_data)
+{
+	struct blank_scan *scan = user_data;
+	const uint8_t *pos = find_not_erased(chunk, len);
+
+	if (pos) {
+		scan->found = offset + (pos - chunk);
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * A NULL chunk stands for a region that is known to be erased and was not read.
+ */
+static int find_blank_chunk(const struct device *dev, off_t offset, const uint8_t *chunk,
+			    size_t len, void *user_data)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct blank_scan *scan = user_data;
+
+	while (len) {
+		size_t pos_in_unit = (offset - scan->region_start) % scan->unit;
+		size_t pos_in_sector = offset % ERASE_SECTOR_SIZE(cfg);
+		size_t seg_len = MIN(MIN(len, scan->unit - pos_in_unit),
+				     ERASE_SECTOR_SIZE(cfg) - pos_in_sector);
+		bool unit_blank;
+
+		if (pos_in_unit == 0) {
+			scan->unit_dirty = false;
+		}
+
+		if (pos_in_sector == 0) {
+			scan->sector_start = offset;
+			scan->sector_dirty = false;
+		}
+
+		if (chunk && !(scan->unit_dirty && scan->sector_dirty) &&
+		    find_not_erased(chunk, seg_len)) {
+			scan->unit_dirty = true;
+			scan->sector_dirty = true;
+		}
+
+		unit_blank = !scan->unit_dirty && pos_in_unit + seg_len == scan->unit;
+
+		if (chunk) {
+			chunk += seg_len;
+		}
+		offset += seg_len;
+		len -= seg_len;
+
+		/* Sectors read completely without finding data are remembered as erased */
+		if (chunk && !scan->sector_dirty && (offset % ERASE_SECTOR_SIZE(cfg)) == 0) {
+			erased_map_update(dev, scan->sector_start, offset - scan->sector_start,
+					  true);
+		}
+
+		if (unit_blank) {
+			scan->found = offset - scan->unit;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Looks for the first byte that is not erased, skipping sectors that are known to be erased.
+ * Sectors found to be erased are remembered. Caller must hold the device lock.
+ */
+static int find_non_blank(const struct device *dev, off_t offset, size_t len, off_t *found)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct blank_scan scan = {.found = -1};
+	off_t start = offset;
+	int err = 0;
+
+	while (len && scan.found < 0) {
+		off_t sector_end = offset - (offset % ERASE_SECTOR_SIZE(cfg)) +
+				   ERASE_SECTOR_SIZE(cfg);
+		size_t run_len = MIN(len, sector_end - offset);
+
+		if (sector_known_erased(dev, offset)) {
+			offset += run_len;
+			len -= run_len;
+			continue;
+		}
+
+		/* Read all following sectors of unknown state in one go */
+		while (run_len < len && !sector_known_erased(dev, offset + run_len)) {
+			run_len += MIN(len - run_len, ERASE_SECTOR_SIZE(cfg));
+		}
+
+		err = stream_range(dev, offset, run_len, find_non_blank_chunk, &scan);
+		if (err != 0) {
+			return err;
+		}
+
+		offset += run_len;
+		len -= run_len;
+	}
+
+	/* Everything in front of the first non-blank byte is erased */
+	erased_map_update(dev, start, ((scan.found < 0) ? offset : scan.found) - start, true);
+
+	*found = scan.found;
+	return 0;
+}
+
+int spi_flash_en25_is_blank(const struct device *dev, off_t offset, size_t len, bool *blank)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	off_t found;
+	int err;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = find_non_blank(dev, offset, len, &found);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	if (err == 0) {
+		*blank = (found < 0);
+	}
+
+	return err;
+}
+
+int spi_flash_en25_find_non_blank(const struct device *dev, off_t offset, size_t len,
+				  off_t *found)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = find_non_blank(dev, offset, len, found);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	if (err == 0 && *found < 0) {
+		err = -ENOENT;
+	}
+
+	return err;
+}
+
+/*
+ * Looks for the first erased unit. Sectors known to be erased are not read, and sectors found to
+ * be erased are remembered. Caller must hold the device lock.
+ */
+static int find_blank(const struct device *dev, off_t offset, size_t len, struct blank_scan *scan)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int err;
+
+	while (len && scan->found < 0) {
+		off_t sector_end = offset - (offset % ERASE_SECTOR_SIZE(cfg)) +
+				   ERASE_SECTOR_SIZE(cfg);
+		size_t run_len = MIN(len, sector_end - offset);
+
+		if (sector_known_erased(dev, offset)) {
+			(void)find_blank_chunk(dev, offset, NULL, run_len, scan);
+		} else {
+			/* Read all following sectors of unknown state in one go */
+			while (run_len < len && !sector_known_erased(dev, offset + run_len)) {
+				run_len += MIN(len - run_len, ERASE_SECTOR_SIZE(cfg));
+			}
+
+			err = stream_range(dev, offset, run_len, find_blank_chunk, scan);
+			if (err != 0) {
+				return err;
+			}
+		}
+
+		offset += run_len;
+		len -= run_len;
+	}
+
+	return 0;
+}
+
+int spi_flash_en25_find_blank(const struct device *dev, off_t offset, size_t len, size_t unit,
+			      off_t *found)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct blank_scan scan = {
+		.found = -1,
+		.unit = unit,
+		.region_start = offset,
+		.sector_start = offset,
+	};
+	int err;
+
+	if (!is_valid_request(offset, len, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	if (unit == 0) {
+		return -EINVAL;
+	}
+
+	int m_err = lock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	err = find_blank(dev, offset, len, &scan);
+
+	m_err = unlock_device(dev);
+	if (m_err) {
+		return m_err;
+	}
+
+	if (err == 0 && scan.found < 0) {
+		err = -ENOENT;
+	}
+
+	*found = scan.found;
+	return err;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK) */
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+static uint32_t emergency_left_us(uint32_t start, uint32_t deadline_us)
+{
+	uint32_t elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	return (elapsed_us < deadline_us) ? deadline_us - elapsed_us : 0;
+}
+
+/*
+ * Takes the external mutex if this MCU can have it right away. Fairness towards the other MCU no
+ * longer matters, but the flash is not taken from it while it owns it.
+ */
+static int try_acquire_ext_mutex(const struct device *dev)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+	if (cfg->ext_request) {
+		struct spi_flash_en25_data *data = get_dev_data(dev);
+		k_spinlock_key_t key = k_spin_lock(&data->ext_lock);
+		bool owned = data->ext_owned;
+
+		if (owned) {
+			data->ext_users++;
+		}
+
+		k_spin_unlock(&data->ext_lock, key);
+
+		if (!owned) {
+			return -EBUSY;
+		}
+
+		handshake_bus_update(dev);
+		return 0;
+	}
+#endif
+#if ANY_INST_HAS_EXT_MUTEX_GPIOS
+	if (cfg->ext_mutex) {
+		/* The pin may be driven by an operation of this MCU that is waiting for the lock */
+		if (ext_mutex_pin_join(dev)) {
+			return 0;
+		}
+
+		if (gpio_pin_get_dt(cfg->ext_mutex)) {
+			return -EBUSY;
+		}
+
+		/* The clock check of the slave role takes milliseconds, so it is skipped */
+		if (gpio_pin_configure_dt(cfg->ext_mutex, GPIO_OUTPUT_ACTIVE)) {
+			return -EIO;
+		}
+
+		atomic_inc(&get_dev_data(dev)->ext_pin_users);
+		ext_bus_connect(dev);
+	}
+#endif
+	ARG_UNUSED(cfg);
+	return 0;
+}
+
+/*
+ * Takes the device lock and the external mutex before the deadline. The operation holding the
+ * lock gives up at its next status poll.
+ */
+static int emergency_lock(const struct device *dev, uint32_t start, uint32_t deadline_us)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+	int err;
+
+	atomic_set(&data->emergency, 1);
+	k_sem_give(&data->emergency_wake);
+
+	err = k_sem_take(&data->lock, K_USEC(emergency_left_us(start, deadline_us)));
+
+	atomic_clear(&data->emergency);
+	k_sem_reset(&data->emergency_wake);
+
+	if (err) {
+		return -ETIMEDOUT;
+	}
+
+	while (try_acquire_ext_mutex(dev) != 0) {
+		if (!emergency_left_us(start, deadline_us)) {
+			release(dev);
+			return -ETIMEDOUT;
+		}
+		k_busy_wait(CONFIG_SPI_FLASH_EN25_EMERGENCY_POLL_US);
+	}
+
+	return 0;
+}
+
+/*
+ * Gets the chip ready to program: brings it out of deep power-down and abandons an erase or
+ * program left behind by an aborted operation. Returns whether it was in deep power-down.
+ */
+static int emergency_wake_chip(const struct device *dev, uint32_t start, uint32_t deadline_us,
+			       bool *was_dpd)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	uint8_t status;
+	int err;
+
+	*was_dpd = false;
+
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+	enum pm_device_state state;
+
+	if (pm_device_state_get(dev, &state) == 0 && state == PM_DEVICE_STATE_SUSPENDED) {
+		*was_dpd = true;
+		send_cmd_op(dev, CMD_EXIT_DPD, cfg->t_exit_dpd);
+	}
+#endif
+
+	if (power_idle_state(dev) != SPI_FLASH_EN25_POWER_DPD) {
+		(void)power_set(dev, SPI_FLASH_EN25_POWER_ACTIVE);
+	}
+
+	err = read_status_register(dev, &status);
+	if (err != 0 || !(status & STATUS_REG_WRITE_IN_PROGRESS)) {
+		return err;
+	}
+
+	/* The aborted operation has already failed, so whatever it was doing can be dropped */
+	LOG_WRN("Resetting busy chip for emergency save");
+	err = send_reset(dev);
+	if (err == 0) {
+		/* Polled against the deadline, perform_reset_sequence() would sleep */
+		err = poll_until_ready(dev, CONFIG_SPI_FLASH_EN25_EMERGENCY_POLL_US,
+				       emergency_left_us(start, deadline_us));
+	}
+
+	return err;
+}
+
+int spi_flash_en25_emergency_save(const struct device *dev, const void *data, size_t len,
+				  uint32_t deadline_us, size_t *written)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *dev_data = get_dev_data(dev);
+	uint32_t start = k_cycle_get_32();
+	const uint8_t *src = data;
+	bool was_dpd;
+	int err;
+
+	*written = 0;
+
+	if (!cfg->emergency_size) {
+		return -ENOTSUP;
+	}
+
+	if (len > cfg->emergency_size) {
+		return -EINVAL;
+	}
+
+	if (!atomic_cas(&dev_data->emergency_state, EMERGENCY_ARMED, EMERGENCY_SAVING)) {
+		return -EAGAIN;
+	}
+
+	err = emergency_lock(dev, start, deadline_us);
+	if (err) {
+		/* Nothing was written, the region is still erased */
+		atomic_set(&dev_data->emergency_state, EMERGENCY_ARMED);
+		return err;
+	}
+
+	err = emergency_wake_chip(dev, start, deadline_us, &was_dpd);
+
+	/*
+	 * The armed region was found erased, so discarded sectors in it need no erase, and the
+	 * background erase must not wipe the snapshot later.
+	 */
+	discard_clear(dev, cfg->emergency_offset, cfg->emergency_size);
+
+	/* The region is erased and write sector aligned, so pages are programmed right away */
+	while (err == 0 && *written < len) {
+		size_t chunk_len = MIN(len - *written, WRITE_SECTOR_SIZE(cfg));
+		const struct spi_buf buf = {
+			.buf = (void *)&src[*written],
+			.len = chunk_len,
+		};
+
+		err = send_page_program(dev, cfg->emergency_offset + *written, &buf, 1, chunk_len);
+		if (err == 0) {
+			err = poll_until_ready(dev, CONFIG_SPI_FLASH_EN25_EMERGENCY_POLL_US,
+					       emergency_left_us(start, deadline_us));
+		}
+		if (err == 0) {
+			*written += chunk_len;
+		}
+	}
+
+	if (err == 0 && !emergency_left_us(start, deadline_us)) {
+		err = -ETIMEDOUT;
+	}
+
+	if (was_dpd) {
+		send_cmd_op(dev, CMD_ENTER_DPD, cfg->t_enter_dpd);
+	}
+
+	(void)unlock_device(dev);
+
+	atomic_set(&dev_data->emergency_state, EMERGENCY_USED);
+
+	return err;
+}
+
+int spi_flash_en25_emergency_rearm(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	if (!get_dev_config(dev)->emergency_size) {
+		return -ENOTSUP;
+	}
+
+	switch (atomic_get(&data->emergency_state)) {
+	case EMERGENCY_ARMED:
+		return 0;
+	case EMERGENCY_SAVING:
+		return -EBUSY;
+	default:
+		atomic_set(&data->emergency_state, EMERGENCY_ERASING);
+		k_work_submit_to_queue(&data->workq, &data->emergency_work);
+		return 0;
+	}
+}
+
+bool spi_flash_en25_emergency_is_armed(const struct device *dev)
 {
-	return (addr >= 0 && (addr + size) <= chip_size);
+	return atomic_get(&get_dev_data(dev)->emergency_state) == EMERGENCY_ARMED;
 }
 
-static int spi_flash_en25_read(const struct device *dev, off_t offset, void *data, size_t len)
+/*
+ * Finds out whether the region is erased, and erases it when re-armed.
+ */
+static void emergency_work_handler(struct k_work *work)
 {
+	struct spi_flash_en25_data *data =
+		CONTAINER_OF(work, struct spi_flash_en25_data, emergency_work);
+	const struct device *dev = data->dev;
 	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	atomic_val_t state = atomic_get(&data->emergency_state);
+	bool blank = false;
 	int err;
 
-	if (!is_valid_request(offset, len, cfg->chip_size)) {
-		return -ENODEV;
+	err = spi_flash_en25_is_blank(dev, cfg->emergency_offset, cfg->emergency_size, &blank);
+	if (err == 0 && !blank && state == EMERGENCY_ERASING) {
+		err = spi_flash_en25_erase(dev, cfg->emergency_offset, cfg->emergency_size);
+		blank = (err == 0);
 	}
 
-	uint8_t const op_and_addr[] = {
-		CMD_READ,
-		(offset >> 16) & 0xFF,
-		(offset >> 8) & 0xFF,
-		(offset >> 0) & 0xFF,
-	};
-	const struct spi_buf tx_buf[] = {{
-		.buf = (void *)&op_and_addr,
-		.len = sizeof(op_and_addr),
-	}};
-	const struct spi_buf rx_buf[] = {{
-						 .len = sizeof(op_and_addr),
-					 },
-					 {
-						 .buf = data,
-						 .len = len,
-					 }};
-	DEF_BUF_SET(tx_buf_set, tx_buf);
-	DEF_BUF_SET(rx_buf_set, rx_buf);
+	if (err) {
+		LOG_ERR("Preparing emergency save region failed, err: %d", err);
+		return;
+	}
 
-	int m_err = acquire_ext_mutex(dev);
-	if (m_err) {
-		return m_err;
+	/* A region that still holds a snapshot is kept until the application re-arms it */
+	if (!atomic_cas(&data->emergency_state, state,
+			blank ? EMERGENCY_ARMED : EMERGENCY_USED)) {
+		/* Re-armed while the region was being checked */
+		k_work_submit_to_queue(&data->workq, work);
+	}
+}
+
+/*
+ * Queues the check of the region once the chip was brought up, it may still hold the snapshot of
+ * the last brownout.
+ */
+static void emergency_boot_check(const struct device *dev)
+{
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	if (get_dev_config(dev)->emergency_size) {
+		k_work_submit_to_queue(&data->workq, &data->emergency_work);
+	}
+}
+#else
+static void emergency_boot_check(const struct device *dev) {}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD)
+int spi_flash_en25_discard(const struct device *dev, off_t offset, size_t size)
+{
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	struct spi_flash_en25_data *data = get_dev_data(dev);
+
+	if (!is_valid_request(offset, size, CHIP_SIZE(cfg))) {
+		return -ENODEV;
+	}
+
+	if (((offset % ERASE_SECTOR_SIZE(cfg)) != 0) || ((size % ERASE_SECTOR_SIZE(cfg)) != 0)) {
+		return -EINVAL;
 	}
 
+	/* Only the bitmap is touched, so the external mutex is not needed */
 	acquire(dev);
-	err = spi_transceive_dt(&cfg->bus, &tx_buf_set, &rx_buf_set);
+
+	for (off_t sector = offset / ERASE_SECTOR_SIZE(cfg);
+	     sector < (offset + size) / ERASE_SECTOR_SIZE(cfg); sector++) {
+		if (!atomic_test_and_set_bit(data->discard_map, sector)) {
+			atomic_inc(&data->discard_count);
+		}
+	}
+
 	release(dev);
 
-	m_err = release_ext_mutex(dev);
-	if (m_err) {
-		return m_err;
+	k_work_reschedule_for_queue(&data->workq, &data->discard_work,
+				    K_MSEC(CONFIG_SPI_FLASH_EN25_DISCARD_IDLE_TIMEOUT));
+
+	return 0;
+}
+
+/*
+ * Erases one run of discarded sectors per invocation, using the largest erase command the
+ * alignment allows, and reschedules itself until no discarded sectors remain.
+ */
+static void discard_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct spi_flash_en25_data *data =
+		CONTAINER_OF(dwork, struct spi_flash_en25_data, discard_work);
+	const struct device *dev = data->dev;
+	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	size_t sector_count = CHIP_SIZE(cfg) / ERASE_SECTOR_SIZE(cfg);
+	size_t first, last;
+	uint8_t opcode;
+	int err;
+
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+	enum pm_device_state state;
+
+	/* Commands are ignored in deep power-down, try again after the next operation */
+	if (pm_device_state_get(dev, &state) == 0 && state != PM_DEVICE_STATE_ACTIVE) {
+		return;
 	}
+#endif
 
-	if (err != 0) {
-		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+	/* Somebody is using the flash, so it is not idle */
+	if (k_sem_count_get(&data->lock) == 0) {
+		return;
 	}
 
-	return (err != 0) ? -EIO : 0;
+	if (lock_device(dev) != 0) {
+		k_work_reschedule_for_queue(&data->workq, dwork,
+					    K_MSEC(CONFIG_SPI_FLASH_EN25_DISCARD_IDLE_TIMEOUT));
+		return;
+	}
+
+	for (first = 0; first < sector_count; first++) {
+		if (atomic_test_bit(data->discard_map, first)) {
+			break;
+		}
+	}
+	for (last = first; last < sector_count; last++) {
+		if (!atomic_test_bit(data->discard_map, last)) {
+			break;
+		}
+	}
+
+	if (first < sector_count) {
+		off_t offset = first * ERASE_SECTOR_SIZE(cfg);
+		size_t run_len = (last - first) * ERASE_SECTOR_SIZE(cfg);
+
+		if (is_erase_possible(ERASE_FULL_BLOCK_SIZE(cfg), offset, run_len)) {
+			opcode = CMD_FULL_BLOCK_ERASE;
+		} else if (is_erase_possible(ERASE_HALF_BLOCK_SIZE(cfg), offset, run_len)) {
+			opcode = CMD_HALF_BLOCK_ERASE;
+		} else {
+			opcode = CMD_SECTOR_ERASE;
+		}
+
+		err = perform_erase_op(dev, opcode, offset);
+		if (err != 0) {
+			LOG_ERR("Background erase at 0x%lx failed, err: %d", (long)offset, err);
+		}
+	}
+
+	(void)unlock_device(dev);
+
+	/* Keep going right away, foreground operations only wait for a single erase */
+	if (atomic_get(&data->discard_count)) {
+		k_work_reschedule_for_queue(&data->workq, dwork, K_NO_WAIT);
+	}
 }
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD) */
 
-static int perform_write(const struct device *dev, off_t offset, const void *data, size_t len)
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_ERASE_LIST)
+/*
+ * Sorts ranges by offset. Lists are short and often nearly sorted, so insertion sort does.
+ */
+static void erase_list_sort(struct spi_flash_en25_erase_range *ranges, size_t count)
+{
+	for (size_t i = 1; i < count; i++) {
+		struct spi_flash_en25_erase_range range = ranges[i];
+		size_t j = i;
+
+		while (j > 0 && ranges[j - 1].offset > range.offset) {
+			ranges[j] = ranges[j - 1];
+			j--;
+		}
+		ranges[j] = range;
+	}
+}
+
+int spi_flash_en25_erase_list(const struct device *dev, struct spi_flash_en25_erase_range *ranges,
+			      size_t count, uint32_t *busy_us)
 {
 	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	int64_t busy = 0;
+	size_t i = 0;
+	bool locked;
 	int err;
-	err = set_write_enable(dev);
-	if (err != 0) {
-		return err;
+
+	erase_list_sort(ranges, count);
+
+	for (size_t j = 0; j < count; j++) {
+		if (!is_valid_request(ranges[j].offset, ranges[j].size, CHIP_SIZE(cfg))) {
+			ranges[j].result = -ENODEV;
+		} else if ((((size_t)ranges[j].offset % ERASE_SECTOR_SIZE(cfg)) != 0) ||
+			   ((ranges[j].size % ERASE_SECTOR_SIZE(cfg)) != 0)) {
+			ranges[j].result = -EINVAL;
+		} else {
+			ranges[j].result = -EINPROGRESS;
+		}
 	}
 
-	uint8_t const op_and_addr[] = {
-		CMD_PAGE_PROGRAM,
-		(offset >> 16) & 0xFF,
-		(offset >> 8) & 0xFF,
-		(offset >> 0) & 0xFF,
-	};
-	const struct spi_buf tx_buf[] = {{
-						 .buf = (void *)&op_and_addr,
-						 .len = sizeof(op_and_addr),
-					 },
-					 {
-						 .buf = (void *)data,
-						 .len = len,
-					 }};
-	DEF_BUF_SET(tx_buf_set, tx_buf);
+	/* A failed lock fails all valid ranges */
+	err = lock_device(dev);
+	locked = (err == 0);
 
-	err = spi_write_dt(&cfg->bus, &tx_buf_set);
-	if (err != 0) {
-		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
+	while (i < count) {
+		off_t start = ranges[i].offset;
+		off_t end = start + ranges[i].size;
+		size_t last = i;
+		int64_t run_start;
+
+		if (ranges[i].result != -EINPROGRESS) {
+			i++;
+			continue;
+		}
+
+		if (err) {
+			ranges[i].result = err;
+			i++;
+			continue;
+		}
+
+		/* Merge overlapping and adjacent ranges into a single run */
+		for (size_t j = i + 1; j < count; j++) {
+			if (ranges[j].result != -EINPROGRESS) {
+				continue;
+			}
+			if (ranges[j].offset > end) {
+				break;
+			}
+			end = MAX(end, ranges[j].offset + (off_t)ranges[j].size);
+			last = j;
+		}
+
+		run_start = k_uptime_ticks();
+		err = erase_region(dev, start, end - start);
+		busy += k_uptime_ticks() - run_start;
+
+		for (size_t j = i; j <= last; j++) {
+			if (ranges[j].result == -EINPROGRESS) {
+				ranges[j].result = err;
+			}
+		}
+
+		/* Ranges after a failed run are not attempted */
+		if (err) {
+			err = -ECANCELED;
+		}
+
+		i = last + 1;
+	}
+
+	if (locked) {
+		int m_err = unlock_device(dev);
+
+		if (m_err) {
+			return m_err;
+		}
+	}
+
+	if (busy_us) {
+		*busy_us = k_ticks_to_us_floor32(busy);
+	}
+
+	for (size_t j = 0; j < count; j++) {
+		if (ranges[j].result) {
+			return ranges[j].result;
+		}
+	}
+
+	return 0;
+}
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_ERASE_LIST) */
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BACKING_STORE)
+/*
+ * Demand paging backing store in the fixed partition chosen as irnas,en25-backing-store. Every data
+ * page gets a slot of whole erase sectors. Page-outs are staged in RAM and flushed in batches, so
+ * neighbouring slots can be erased with block erases and the device is locked once per batch.
+ * Page-ins bypass the IO queue, the QoS scheduler and the prefetch window.
+ */
+#define BS_NODE DT_CHOSEN(irnas_en25_backing_store)
+#define BS_DEV	DT_GPARENT(BS_NODE)
+
+BUILD_ASSERT(DT_NODE_HAS_COMPAT(BS_DEV, mxicy_en25),
+	     "irnas,en25-backing-store must be a partition of an EN25 flash");
+
+#define BS_SECTOR_SIZE DT_PROP(BS_DEV, erase_sector_size)
+#define BS_SLOT_SIZE   ROUND_UP(CONFIG_MMU_PAGE_SIZE, BS_SECTOR_SIZE)
+#define BS_SLOTS       (DT_REG_SIZE(BS_NODE) / BS_SLOT_SIZE)
+#define BS_SLOT_OFFSET(slot) ((off_t)(DT_REG_ADDR(BS_NODE) + (slot) * BS_SLOT_SIZE))
+#define BS_BATCH       CONFIG_SPI_FLASH_EN25_BACKING_STORE_BATCH
+
+/* Marks unused map entries and staging buffers */
+#define BS_NO_SLOT UINT16_MAX
+
+BUILD_ASSERT((DT_REG_ADDR(BS_NODE) % BS_SECTOR_SIZE) == 0,
+	     "Backing store partition must start on an erase sector");
+BUILD_ASSERT(BS_SLOTS >= 2, "Backing store partition is too small");
+BUILD_ASSERT(BS_SLOTS < BS_NO_SLOT, "Backing store partition is too large");
+BUILD_ASSERT(Z_NUM_PAGE_FRAMES < BS_NO_SLOT, "Too many page frames");
+
+static const struct device *const bs_dev = DEVICE_DT_GET(BS_DEV);
+
+/* Allocator state, also taken from location_get() and location_free() with interrupts locked */
+static struct k_spinlock bs_lock;
+static ATOMIC_DEFINE(bs_used, BS_SLOTS);
+static ATOMIC_DEFINE(bs_erased, BS_SLOTS);
+static uint32_t bs_used_count;
+static uint32_t bs_cursor;
+
+/* Slot holding the current contents of each page frame, and the reverse */
+static uint16_t bs_frame_slot[Z_NUM_PAGE_FRAMES];
+static uint16_t bs_slot_frame[BS_SLOTS];
+
+/* Page-outs not yet written, protected by bs_sem. Slot numbers are also cleared by
+ * location_free(), under bs_lock.
+ */
+static K_SEM_DEFINE(bs_sem, 1, 1);
+static uint8_t bs_batch[BS_BATCH][CONFIG_MMU_PAGE_SIZE] __aligned(sizeof(uint32_t));
+static uint16_t bs_batch_slot[BS_BATCH];
+
+static struct spi_flash_en25_backing_store_stats bs_stats;
+
+static uint16_t bs_frame_index(struct z_page_frame *pf) { return pf - z_page_frames; }
+
+/* Called with bs_lock held */
+static void bs_forget_frame_of(uint16_t slot)
+{
+	if (bs_slot_frame[slot] != BS_NO_SLOT) {
+		bs_frame_slot[bs_slot_frame[slot]] = BS_NO_SLOT;
+		bs_slot_frame[slot] = BS_NO_SLOT;
+	}
+}
+
+int k_mem_paging_backing_store_location_get(struct z_page_frame *pf, uintptr_t *location,
+					    bool page_fault)
+{
+	uint16_t frame = bs_frame_index(pf);
+	k_spinlock_key_t key = k_spin_lock(&bs_lock);
+	uint16_t slot = bs_frame_slot[frame];
+
+	if (slot != BS_NO_SLOT) {
+		/* A clean page keeps the slot it was paged in from. The frame is being vacated. */
+		bs_forget_frame_of(slot);
+	} else if (bs_used_count + (page_fault ? 0 : 1) >= BS_SLOTS) {
+		/* The last free slot is kept for page faults, so they can always make progress */
+		k_spin_unlock(&bs_lock, key);
+		return -ENOMEM;
 	} else {
-		err = wait_until_ready(dev);
+		/*
+		 * Next fit spreads the wear and keeps consecutive page-outs in
+		 * neighbouring slots.
+		 */
+		slot = bs_cursor;
+		while (atomic_test_bit(bs_used, slot)) {
+			slot = (slot + 1) % BS_SLOTS;
+		}
+		bs_cursor = (slot + 1) % BS_SLOTS;
+
+		atomic_set_bit(bs_used, slot);
+		bs_used_count++;
 	}
 
-	return (err != 0) ? -EIO : 0;
+	k_spin_unlock(&bs_lock, key);
+	*location = slot;
+
+	return 0;
 }
 
-static int spi_flash_en25_write(const struct device *dev, off_t offset, const void *data,
-				size_t len)
+void k_mem_paging_backing_store_location_free(uintptr_t location)
 {
-	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
-	int err = 0;
+	uint16_t slot = location;
+	k_spinlock_key_t key = k_spin_lock(&bs_lock);
 
-	if (!is_valid_request(offset, len, cfg->chip_size)) {
-		return -ENODEV;
+	if (atomic_test_and_clear_bit(bs_used, slot)) {
+		bs_used_count--;
 	}
+	bs_forget_frame_of(slot);
 
-	int m_err = acquire_ext_mutex(dev);
-	if (m_err) {
-		return m_err;
+	/* Staged data of a freed slot is dropped instead of written */
+	for (size_t i = 0; i < BS_BATCH; i++) {
+		if (bs_batch_slot[i] == slot) {
+			bs_batch_slot[i] = BS_NO_SLOT;
+		}
 	}
 
-	acquire(dev);
+	k_spin_unlock(&bs_lock, key);
+}
 
-	while (len) {
-		size_t chunk_len = len;
-		off_t current_page_start = offset - (offset & (cfg->write_sector_size - 1));
-		off_t current_page_end = current_page_start + cfg->write_sector_size;
+/*
+ * Erases the slots of the staged pages and programs them. Runs of neighbouring slots that are not
+ * known to be erased are erased together, before any page is programmed. Caller must hold the
+ * device lock and bs_sem.
+ */
+static int bs_write_batch(const uint16_t *slots, const size_t *idx, size_t count)
+{
+	int err = 0;
 
-		if (chunk_len > (current_page_end - offset)) {
-			chunk_len = (current_page_end - offset);
+	for (size_t i = 0; i < count;) {
+		size_t last = i;
+
+		if (atomic_test_bit(bs_erased, slots[i])) {
+			i++;
+			continue;
+		}
+		while (last + 1 < count && slots[last + 1] == slots[last] + 1 &&
+		       !atomic_test_bit(bs_erased, slots[last + 1])) {
+			last++;
 		}
 
-		err = perform_write(dev, offset, data, chunk_len);
-		if (err != 0) {
+		err = erase_region(bs_dev, BS_SLOT_OFFSET(slots[i]),
+				   (last - i + 1) * BS_SLOT_SIZE);
+		if (err) {
 			break;
 		}
 
-		data = (uint8_t *)data + chunk_len;
-		offset += chunk_len;
-		len -= chunk_len;
+		for (; i <= last; i++) {
+			atomic_set_bit(bs_erased, slots[i]);
+		}
 	}
 
-	release(dev);
-
-	m_err = release_ext_mutex(dev);
-	if (m_err) {
-		return m_err;
+	for (size_t i = 0; !err && i < count; i++) {
+		atomic_clear_bit(bs_erased, slots[i]);
+		err = write_pages(bs_dev, BS_SLOT_OFFSET(slots[i]), bs_batch[idx[i]],
+				  CONFIG_MMU_PAGE_SIZE);
 	}
 
 	return err;
-}
-
-/* For this will stayed commented out as we dont need it */
-// static int disable_block_protect(const struct device *dev)
-//{
-//     int err;
-//     err = set_write_enable(dev);
-//	if (err != 0) {
-//         return err;
-//     }
-//
-//	uint8_t const op_and_addr[] = {
-//         CMD_PAGE_PROGRAM,
-//		0b00111100,
-//	};
-//
-//	const struct spi_buf tx_buf[] = {
-//		{
-//			.buf = (void *)&op_and_addr,
-//			.len = sizeof(op_and_addr),
-//		}
-//	};
-//
-//	DEF_BUF_SET(tx_buf_set, tx_buf);
-//
-//	err = spi_write(get_dev_data(dev)->spi,
-//			&get_dev_config(dev)->spi_cfg,
-//			&tx_buf_set);
-//	if (err != 0) {
-//		LOG_ERR("SPI transaction failed with code: %d/%u",
-//			err, __LINE__);
-//	} else {
-//		err = wait_until_ready(dev);
-//	}
-//
-//	return (err != 0) ? -EIO : 0;
-// }
+}
 
-static int perform_chip_erase(const struct device *dev)
+/*
+ * Writes all staged pages under a single device lock and empties the batch. Caller must hold
+ * bs_sem.
+ */
+static void bs_flush(void)
 {
-	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	uint16_t slots[BS_BATCH];
+	size_t idx[BS_BATCH];
+	size_t count = 0;
+	k_spinlock_key_t key;
 	int err;
-	err = set_write_enable(dev);
-	if (err != 0) {
-		return err;
+
+	/* Staged pages in slot order */
+	key = k_spin_lock(&bs_lock);
+	for (size_t i = 0; i < BS_BATCH; i++) {
+		size_t j;
+
+		if (bs_batch_slot[i] == BS_NO_SLOT) {
+			continue;
+		}
+		for (j = count++; j > 0 && slots[j - 1] > bs_batch_slot[i]; j--) {
+			slots[j] = slots[j - 1];
+			idx[j] = idx[j - 1];
+		}
+		slots[j] = bs_batch_slot[i];
+		idx[j] = i;
 	}
+	k_spin_unlock(&bs_lock, key);
 
-	uint8_t const chip_erase_cmd = CMD_CHIP_ERASE;
-	const struct spi_buf tx_buf[] = {{
-		.buf = (void *)&chip_erase_cmd,
-		.len = sizeof(chip_erase_cmd),
-	}};
-	DEF_BUF_SET(tx_buf_set, tx_buf);
+	if (count) {
+		err = lock_device(bs_dev);
+		if (!err) {
+			err = bs_write_batch(slots, idx, count);
 
-	err = spi_write_dt(&cfg->bus, &tx_buf_set);
-	if (err != 0) {
-		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
-	} else {
-		err = wait_until_ready(dev);
+			int m_err = unlock_device(bs_dev);
+
+			err = err ? err : m_err;
+		}
+
+		if (err) {
+			/* The evicted pages are lost */
+			LOG_ERR("Backing store write failed: %d", err);
+			k_panic();
+		}
+
+		bs_stats.flushes++;
 	}
 
-	return (err != 0) ? -EIO : 0;
+	key = k_spin_lock(&bs_lock);
+	for (size_t i = 0; i < BS_BATCH; i++) {
+		bs_batch_slot[i] = BS_NO_SLOT;
+	}
+	k_spin_unlock(&bs_lock, key);
 }
 
-/**
- * @brief Check if erase can be performed at this offset with this size
- *
- * @param[in] entity_size The size of the erasable entity (block/sector of flash)
- * @param[in] offset The current offset of the erase operation
- * @param[in] requested_size The number of bytes to erase
- *
- * @retval true The requested erase operation can be performed
- * @retval false The requested erase operation can NOT be performed
- */
-static bool is_erase_possible(size_t entity_size, off_t offset, size_t requested_size)
+void k_mem_paging_backing_store_page_out(uintptr_t location)
 {
-	/* 1. The size we want to erase must be the same or larger then the entity size
-	 * 2. The offset must be a multiple of the requested entity size
-	 */
-	return (requested_size >= entity_size) && (offset % entity_size == 0);
+	uint16_t slot = location;
+	size_t free_idx = BS_BATCH;
+	size_t i;
+
+	k_sem_take(&bs_sem, K_FOREVER);
+
+	for (i = 0; i < BS_BATCH; i++) {
+		if (bs_batch_slot[i] == slot) {
+			break;
+		}
+		if (bs_batch_slot[i] == BS_NO_SLOT && free_idx == BS_BATCH) {
+			free_idx = i;
+		}
+	}
+
+	if (i == BS_BATCH) {
+		if (free_idx == BS_BATCH) {
+			bs_flush();
+			free_idx = 0;
+		}
+		i = free_idx;
+	}
+
+	memcpy(bs_batch[i], Z_SCRATCH_PAGE, CONFIG_MMU_PAGE_SIZE);
+
+	k_spinlock_key_t key = k_spin_lock(&bs_lock);
+
+	bs_batch_slot[i] = slot;
+	k_spin_unlock(&bs_lock, key);
+
+	bs_stats.page_outs++;
+
+	k_sem_give(&bs_sem);
 }
 
-static int perform_erase_op(const struct device *dev, uint8_t opcode, off_t offset)
+/*
+ * Reads a slot without the deferred init wait, a slot is only read after it was written.
+ */
+static int bs_read(off_t offset, void *buf, size_t len)
 {
-	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
-	int err;
-	err = set_write_enable(dev);
-	if (err != 0) {
+	int err = lock_device_common(bs_dev, true);
+
+	if (err) {
 		return err;
 	}
 
-	uint8_t const op_and_addr[] = {
-		opcode,
-		(offset >> 16) & 0xFF,
-		(offset >> 8) & 0xFF,
-		(offset >> 0) & 0xFF,
-	};
-	const struct spi_buf tx_buf[] = {{
-		.buf = (void *)&op_and_addr,
-		.len = sizeof(op_and_addr),
-	}};
-	DEF_BUF_SET(tx_buf_set, tx_buf);
+	err = perform_read(bs_dev, offset, buf, len);
 
-	err = spi_write_dt(&cfg->bus, &tx_buf_set);
-	if (err != 0) {
-		LOG_ERR("SPI transaction failed with code: %d/%u", err, __LINE__);
-	} else {
-		err = wait_until_ready(dev);
-	}
+	int m_err = unlock_device(bs_dev);
 
-	return (err != 0) ? -EIO : 0;
+	return err ? err : m_err;
 }
 
-static int spi_flash_en25_erase(const struct device *dev, off_t offset, size_t size)
+void k_mem_paging_backing_store_page_in(uintptr_t location)
 {
-	const struct spi_flash_en25_config *cfg = get_dev_config(dev);
+	uint16_t slot = location;
+	uint32_t start = k_cycle_get_32();
+	uint32_t elapsed_us;
 	int err = 0;
+	size_t i;
 
-	if (!is_valid_request(offset, size, cfg->chip_size)) {
-		return -ENODEV;
+	k_sem_take(&bs_sem, K_FOREVER);
+
+	for (i = 0; i < BS_BATCH; i++) {
+		if (bs_batch_slot[i] == slot) {
+			break;
+		}
 	}
 
-	/* Diagnose region errors before starting to erase. */
-	if (((offset % cfg->erase_sector_size) != 0) || ((size % cfg->erase_sector_size) != 0)) {
-		return -EINVAL;
+	if (i < BS_BATCH) {
+		memcpy(Z_SCRATCH_PAGE, bs_batch[i], CONFIG_MMU_PAGE_SIZE);
+		bs_stats.batch_hits++;
+	} else {
+		err = bs_read(BS_SLOT_OFFSET(slot), Z_SCRATCH_PAGE, CONFIG_MMU_PAGE_SIZE);
 	}
 
-	int m_err = acquire_ext_mutex(dev);
-	if (m_err) {
-		return m_err;
+	elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	bs_stats.page_ins++;
+	bs_stats.page_in_total_us += elapsed_us;
+	bs_stats.page_in_max_us = MAX(bs_stats.page_in_max_us, elapsed_us);
+
+	k_sem_give(&bs_sem);
+
+	if (err) {
+		LOG_ERR("Backing store read failed: %d", err);
+		k_panic();
 	}
+}
 
-	acquire(dev);
+void k_mem_paging_backing_store_page_finalize(struct z_page_frame *pf, uintptr_t location)
+{
+	uint16_t frame = bs_frame_index(pf);
+	uint16_t slot = location;
+	k_spinlock_key_t key = k_spin_lock(&bs_lock);
 
-	if (size == cfg->chip_size) {
-		err = perform_chip_erase(dev);
-	} else {
-		while (size) {
-			/* Can we erase a full block? */
-			if (is_erase_possible(cfg->erase_full_block_size, offset, size)) {
-				err = perform_erase_op(dev, CMD_FULL_BLOCK_ERASE, offset);
-				offset += cfg->erase_full_block_size;
-				size -= cfg->erase_full_block_size;
-			}
-			/* Can we erase a half block? */
-			else if (is_erase_possible(cfg->erase_half_block_size, offset, size)) {
-				err = perform_erase_op(dev, CMD_HALF_BLOCK_ERASE, offset);
-				offset += cfg->erase_half_block_size;
-				size -= cfg->erase_half_block_size;
-			}
-			/* Can we erase a sector? */
-			else if (is_erase_possible(cfg->erase_sector_size, offset, size)) {
-				err = perform_erase_op(dev, CMD_SECTOR_ERASE, offset);
-				offset += cfg->erase_sector_size;
-				size -= cfg->erase_sector_size;
-			} else {
-				LOG_ERR("Unsupported erase request: "
-					"size %zu at 0x%lx",
-					size, (long)offset);
-				err = -EINVAL;
-			}
+	/* A slot left from a page that was since unmapped is no longer needed */
+	if (bs_frame_slot[frame] != BS_NO_SLOT && bs_frame_slot[frame] != slot) {
+		uint16_t old = bs_frame_slot[frame];
 
-			if (err != 0) {
-				break;
-			}
+		if (atomic_test_and_clear_bit(bs_used, old)) {
+			bs_used_count--;
 		}
+		bs_slot_frame[old] = BS_NO_SLOT;
 	}
 
-	release(dev);
+	bs_frame_slot[frame] = slot;
+	bs_slot_frame[slot] = frame;
 
-	m_err = release_ext_mutex(dev);
-	if (m_err) {
-		return m_err;
-	}
+	k_spin_unlock(&bs_lock, key);
+}
 
-	return err;
+void k_mem_paging_backing_store_init(void)
+{
+	/* Runs before devices are initialized, so the flash is not touched here */
+	memset(bs_frame_slot, 0xFF, sizeof(bs_frame_slot));
+	memset(bs_slot_frame, 0xFF, sizeof(bs_slot_frame));
+	memset(bs_batch_slot, 0xFF, sizeof(bs_batch_slot));
+}
+
+int spi_flash_en25_backing_store_stats_get(struct spi_flash_en25_backing_store_stats *stats)
+{
+	k_sem_take(&bs_sem, K_FOREVER);
+
+	*stats = bs_stats;
+	stats->slots = BS_SLOTS;
+	stats->slots_used = bs_used_count;
+
+	k_sem_give(&bs_sem);
+
+	return 0;
 }
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_BACKING_STORE) */
 
 #if IS_ENABLED(CONFIG_FLASH_PAGE_LAYOUT)
 static void spi_flash_en25_pages_layout(const struct device *dev,
@@ -746,47 +5166,14 @@ static void spi_flash_en25_pages_layout(const struct device *dev,
 }
 #endif /* IS_ENABLED(CONFIG_FLASH_PAGE_LAYOUT) */
 
-static int spi_flash_en25_init(const struct device *dev)
+/*
+ * Resets the chip and checks that it responds.
+ */
+static int bring_up(const struct device *dev)
 {
 	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
 	int err;
 
-	if (!spi_is_ready_dt(&dev_config->bus)) {
-		LOG_ERR("SPI bus %s not ready", dev_config->bus.bus->name);
-		return -ENODEV;
-	}
-
-	/* GPIO configure */
-
-#if ANY_INST_HAS_WP_GPIOS
-	if (dev_config->wp) {
-		if (gpio_pin_configure_dt(dev_config->wp, GPIO_OUTPUT_ACTIVE)) {
-			LOG_ERR("Couldn't configure write protect pin");
-			return -ENODEV;
-		}
-		gpio_pin_set(dev_config->wp->port, dev_config->wp->pin, 1);
-	}
-#endif
-
-#if ANY_INST_HAS_HOLD_GPIOS
-	if (dev_config->hold) {
-		if (gpio_pin_configure_dt(dev_config->hold, GPIO_OUTPUT_ACTIVE)) {
-			LOG_ERR("Couldn't configure hold pin");
-			return -ENODEV;
-		}
-		gpio_pin_set(dev_config->hold->port, dev_config->hold->pin, 1);
-	}
-#endif
-
-#if ANY_INST_HAS_EXT_MUTEX_GPIOS
-	if (dev_config->ext_mutex) {
-		if (gpio_pin_configure_dt(dev_config->ext_mutex, GPIO_INPUT)) {
-			LOG_ERR("Couldn't configure ext_mutex pin");
-			return -EIO;
-		}
-	}
-#endif
-
 	int m_err = acquire_ext_mutex(dev);
 	if (m_err) {
 		return m_err;
@@ -827,6 +5214,11 @@ static int spi_flash_en25_init(const struct device *dev)
 	/* Place holder for function call, we might need it in future. */
 	// err = disable_block_protect(dev);
 
+	/* Read one byte - this puts flash into a low power state. Read it here, as the read API
+	 * would wait for deferred init to finish. */
+	uint8_t _r[4];
+	err = perform_read(dev, 0, _r, sizeof(_r));
+
 	release(dev);
 
 	m_err = release_ext_mutex(dev);
@@ -834,11 +5226,120 @@ static int spi_flash_en25_init(const struct device *dev)
 		return m_err;
 	}
 
-	/* Read one byte - this puts flash into a low power state */
-	uint8_t _r[4];
-	err = spi_flash_en25_read(dev, 0, _r, sizeof(_r));
+	return err;
+}
+
+static int spi_flash_en25_init(const struct device *dev)
+{
+	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
+
+	if (!spi_is_ready_dt(&dev_config->bus)) {
+		LOG_ERR("SPI bus %s not ready", dev_config->bus.bus->name);
+		return -ENODEV;
+	}
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_BUS_PROFILES)
+	for (int i = 0; i < BUS_PROFILE_COUNT; i++) {
+		struct spi_dt_spec *bus = &get_dev_data(dev)->bus_profile[i];
+
+		*bus = dev_config->bus;
+		if (dev_config->profile_frequency[i]) {
+			bus->config.frequency = dev_config->profile_frequency[i];
+		}
+	}
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD) ||                                                   \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT) ||                                         \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE) ||                                   \
+	IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+	get_dev_data(dev)->dev = dev;
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_WORKQ)
+	k_work_queue_start(&get_dev_data(dev)->workq, get_dev_data(dev)->workq_stack,
+			   CONFIG_SPI_FLASH_EN25_WORKQ_STACK_SIZE,
+			   CONFIG_SPI_FLASH_EN25_WORKQ_PRIORITY,
+			   &(struct k_work_queue_config){.name = dev->name});
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD)
+	k_work_init_delayable(&get_dev_data(dev)->discard_work, discard_work_handler);
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE)
+	k_work_init(&get_dev_data(dev)->emergency_work, emergency_work_handler);
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE)
+	io_queue_init(dev);
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)
+	k_mutex_init(&get_dev_data(dev)->qos_mutex);
+	k_condvar_init(&get_dev_data(dev)->qos_cond);
+#endif
+
+	/* GPIO configure */
+
+#if ANY_INST_HAS_WP_GPIOS
+	if (dev_config->wp) {
+		if (gpio_pin_configure_dt(dev_config->wp, GPIO_OUTPUT_ACTIVE)) {
+			LOG_ERR("Couldn't configure write protect pin");
+			return -ENODEV;
+		}
+		gpio_pin_set(dev_config->wp->port, dev_config->wp->pin, 1);
+	}
+#endif
+
+#if ANY_INST_HAS_HOLD_GPIOS
+	if (dev_config->hold) {
+		if (gpio_pin_configure_dt(dev_config->hold, GPIO_OUTPUT_ACTIVE)) {
+			LOG_ERR("Couldn't configure hold pin");
+			return -ENODEV;
+		}
+		gpio_pin_set(dev_config->hold->port, dev_config->hold->pin, 1);
+	}
+#endif
+
+#if HOLD_PREEMPT_ENABLED
+	hold_preempt_init(dev);
+#endif
+
+#if ANY_INST_HAS_EXT_MUTEX_GPIOS
+	if (dev_config->ext_mutex) {
+		if (gpio_pin_configure_dt(dev_config->ext_mutex, GPIO_INPUT)) {
+			LOG_ERR("Couldn't configure ext_mutex pin");
+			return -EIO;
+		}
+	}
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE)
+	if (dev_config->ext_request || dev_config->ext_grant) {
+		int err = handshake_init(dev);
+
+		if (err) {
+			return err;
+		}
+	}
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT)
+	/* Chip bring-up runs later, the first API call waits for it */
+	k_work_init(&get_dev_data(dev)->init_work, init_work_handler);
+	k_work_submit_to_queue(&get_dev_data(dev)->workq, &get_dev_data(dev)->init_work);
+
+	return 0;
+#else
+	int err = bring_up(dev);
+
+	if (err == 0) {
+		emergency_boot_check(dev);
+	}
 
 	return err;
+#endif
 }
 
 #if IS_ENABLED(CONFIG_PM_DEVICE)
@@ -847,28 +5348,32 @@ static int spi_flash_en25_pm_control(const struct device *dev, enum pm_device_ac
 	const struct spi_flash_en25_config *dev_config = get_dev_config(dev);
 
 	int err = 0;
-	int m_err = acquire_ext_mutex(dev);
+	int m_err = lock_device(dev);
 	if (m_err) {
 		return m_err;
 	}
-	acquire(dev);
 
 	switch (action) {
-	case PM_DEVICE_ACTION_RESUME:
+	case PM_DEVICE_ACTION_RESUME: {
+		uint32_t start = k_cycle_get_32();
+
+		(void)power_set(dev, SPI_FLASH_EN25_POWER_TRANSITION);
 		send_cmd_op(dev, CMD_EXIT_DPD, dev_config->t_exit_dpd);
+		power_dpd_changed(dev, false, k_cyc_to_us_ceil32(k_cycle_get_32() - start));
 		break;
+	}
 
 	case PM_DEVICE_ACTION_SUSPEND:
+		(void)power_set(dev, SPI_FLASH_EN25_POWER_TRANSITION);
 		send_cmd_op(dev, CMD_ENTER_DPD, dev_config->t_enter_dpd);
+		power_dpd_changed(dev, true, 0);
 		break;
 
 	default:
 		err = -ENOTSUP;
 	}
 
-	release(dev);
-
-	m_err = release_ext_mutex(dev);
+	m_err = unlock_device(dev);
 	if (m_err) {
 		return m_err;
 	}
@@ -894,6 +5399,11 @@ static const struct flash_driver_api spi_flash_en25_api = {
 #endif
 };
 
+bool spi_flash_en25_is_en25(const struct device *dev)
+{
+	return dev && dev->api == &spi_flash_en25_api;
+}
+
 #define XSTR(x) STR(x)
 #define STR(x)	#x
 
@@ -924,18 +5434,88 @@ static const struct flash_driver_api spi_flash_en25_api = {
 		   (static const struct gpio_dt_spec spi_clk_##idx =                               \
 			    GPIO_DT_SPEC_GET(DT_DRV_INST(idx), spi_clk_gpios);))
 
+#define INST_HAS_EXT_REQUEST_GPIO(idx) DT_NODE_HAS_PROP(DT_DRV_INST(idx), ext_mutex_request_gpios)
+
+#define INST_EXT_REQUEST_GPIO_SPEC(idx)                                                            \
+	IF_ENABLED(INST_HAS_EXT_REQUEST_GPIO(idx),                                                 \
+		   (static const struct gpio_dt_spec ext_request_##idx =                           \
+			    GPIO_DT_SPEC_GET(DT_DRV_INST(idx), ext_mutex_request_gpios);))
+
+#define INST_HAS_EXT_GRANT_GPIO(idx) DT_NODE_HAS_PROP(DT_DRV_INST(idx), ext_mutex_grant_gpios)
+
+#define INST_EXT_GRANT_GPIO_SPEC(idx)                                                              \
+	IF_ENABLED(INST_HAS_EXT_GRANT_GPIO(idx),                                                   \
+		   (static const struct gpio_dt_spec ext_grant_##idx =                             \
+			    GPIO_DT_SPEC_GET(DT_DRV_INST(idx), ext_mutex_grant_gpios);))
+
+#define INST_EMERGENCY_REGION(idx, cell)                                                           \
+	COND_CODE_1(DT_INST_NODE_HAS_PROP(idx, emergency_save_region),                             \
+		    (DT_INST_PROP_BY_IDX(idx, emergency_save_region, cell)), (0))
+
 #define SPI_FLASH_EN25_INST(idx)                                                                   \
 	enum {                                                                                     \
 		INST_##idx##_BYTES = (DT_INST_PROP(idx, size) / 8),                                \
 		INST_##idx##_PAGES = (INST_##idx##_BYTES / DT_INST_PROP(idx, erase_sector_size)),  \
 	};                                                                                         \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK,                                              \
+		   (static ATOMIC_DEFINE(inst_##idx##_erased_map, INST_##idx##_PAGES);))           \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD,                                                  \
+		   (static ATOMIC_DEFINE(inst_##idx##_discard_map, INST_##idx##_PAGES);))          \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP,                                                  \
+		   (static struct heat_cell inst_##idx##_heat[INST_##idx##_PAGES];))               \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_BOUNCE,                                                   \
+		   (BUILD_ASSERT(CONFIG_SPI_FLASH_EN25_BOUNCE_SIZE >=                              \
+					 DT_INST_PROP(idx, write_sector_size),                     \
+				 "Bounce buffers must hold a write sector");))                     \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE,                                           \
+		   (BUILD_ASSERT((INST_EMERGENCY_REGION(idx, 0) %                                  \
+				  DT_INST_PROP(idx, erase_sector_size)) == 0 &&                    \
+					 (INST_EMERGENCY_REGION(idx, 1) %                          \
+					  DT_INST_PROP(idx, erase_sector_size)) == 0 &&            \
+					 INST_EMERGENCY_REGION(idx, 0) +                           \
+							 INST_EMERGENCY_REGION(idx, 1) <=  \
+						 INST_##idx##_BYTES,                               \
+				 "emergency-save-region must be sector aligned and inside the "    \
+				 "flash");))                                                       \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE,                                                 \
+		   (static K_KERNEL_STACK_DEFINE(inst_##idx##_io_stack,                            \
+						 CONFIG_SPI_FLASH_EN25_IO_QUEUE_STACK_SIZE);))     \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_WORKQ,                                                    \
+		   (static K_KERNEL_STACK_DEFINE(inst_##idx##_workq_stack,                         \
+						 CONFIG_SPI_FLASH_EN25_WORKQ_STACK_SIZE);))        \
 	static struct spi_flash_en25_data inst_##idx##_data = {                                    \
 		.lock = Z_SEM_INITIALIZER(inst_##idx##_data.lock, 1, 1),                           \
-		IF_ENABLED(CONFIG_PM_DEVICE, (.pm_state = PM_DEVICE_STATE_ACTIVE))};               \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_DEFERRED_INIT,                                    \
+			   (.init_done = Z_SEM_INITIALIZER(inst_##idx##_data.init_done, 0, 1), ))  \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_IO_QUEUE, (.io_stack = inst_##idx##_io_stack, ))  \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_WORKQ,                                            \
+			   (.workq_stack = inst_##idx##_workq_stack, ))                            \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_HEATMAP, (.heat = inst_##idx##_heat, ))           \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE,                                   \
+			   (.emergency_wake =                                                      \
+				    Z_SEM_INITIALIZER(inst_##idx##_data.emergency_wake, 0, 1), ))  \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_BORROW,                                           \
+			   (.borrow_free = Z_SEM_INITIALIZER(                                      \
+				    inst_##idx##_data.borrow_free,                                 \
+				    CONFIG_SPI_FLASH_EN25_BORROW_SLOTS,                            \
+				    CONFIG_SPI_FLASH_EN25_BORROW_SLOTS), ))                        \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_BULK_READ,                                        \
+			   (.bulk_free = Z_SEM_INITIALIZER(                                        \
+				    inst_##idx##_data.bulk_free,                                   \
+				    CONFIG_SPI_FLASH_EN25_BULK_READ_BUFS,                          \
+				    CONFIG_SPI_FLASH_EN25_BULK_READ_BUFS), ))                      \
+		IF_ENABLED(CONFIG_PM_DEVICE, (.pm_state = PM_DEVICE_STATE_ACTIVE, ))               \
+			IF_ENABLED(CONFIG_SPI_FLASH_EN25_PREFETCH, (.last_read_end = -1, ))        \
+				IF_ENABLED(CONFIG_SPI_FLASH_EN25_BLANK_CHECK,                      \
+					   (.erased_map = inst_##idx##_erased_map, ))              \
+					IF_ENABLED(CONFIG_SPI_FLASH_EN25_DISCARD,                  \
+						   (.discard_map = inst_##idx##_discard_map, ))};  \
 	INST_WP_GPIO_SPEC(idx)                                                                     \
 	INST_HOLD_GPIO_SPEC(idx)                                                                   \
 	INST_EXT_MUTEX_GPIO_SPEC(idx)                                                              \
 	INST_SPI_CLK_GPIO_SPEC(idx)                                                                \
+	IF_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE,                                      \
+		   (INST_EXT_REQUEST_GPIO_SPEC(idx) INST_EXT_GRANT_GPIO_SPEC(idx)))                \
 	static const struct spi_flash_en25_config inst_##idx##_config = {                          \
 		.bus = SPI_DT_SPEC_INST_GET(idx,                                                   \
 					    SPI_OP_MODE_MASTER | SPI_TRANSFER_MSB |                \
@@ -958,12 +5538,44 @@ static const struct flash_driver_api spi_flash_en25_api = {
 		.t_enter_dpd = DIV_ROUND_UP(DT_INST_PROP(idx, enter_dpd_delay), NSEC_PER_USEC),    \
 		.t_exit_dpd = DIV_ROUND_UP(DT_INST_PROP(idx, exit_dpd_delay), NSEC_PER_USEC),      \
 		.use_udpd = DT_INST_PROP(idx, use_udpd),                                           \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_EMERGENCY_SAVE,                                   \
+			   (.emergency_offset = INST_EMERGENCY_REGION(idx, 0),                     \
+			    .emergency_size = INST_EMERGENCY_REGION(idx, 1), ))                    \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_BUS_PROFILES,                                     \
+			   (.profile_frequency =                                                   \
+				    {                                                              \
+					    [BUS_READ] = DT_INST_PROP(idx, read_frequency),        \
+					    [BUS_PROGRAM] = DT_INST_PROP(idx, program_frequency),  \
+					    [BUS_STATUS] = DT_INST_PROP(idx, status_frequency),    \
+				    }, ))                                                          \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_POWER_STATS,                                      \
+			   (.current_ua =                                                          \
+				    {                                                              \
+					    [SPI_FLASH_EN25_POWER_STANDBY] =                       \
+						    DT_INST_PROP(idx, standby_current_ua),         \
+					    [SPI_FLASH_EN25_POWER_ACTIVE] =                        \
+						    DT_INST_PROP(idx, active_current_ua),          \
+					    [SPI_FLASH_EN25_POWER_BUSY] =                          \
+						    DT_INST_PROP(idx, busy_current_ua),            \
+					    [SPI_FLASH_EN25_POWER_TRANSITION] =                    \
+						    DT_INST_PROP(idx, active_current_ua),          \
+					    [SPI_FLASH_EN25_POWER_DPD] =                           \
+						    DT_INST_PROP(idx, dpd_current_ua),             \
+				    },                                                             \
+			    .supply_mv = DT_INST_PROP(idx, supply_voltage_mv), ))                  \
 		.jedec_id = DT_INST_PROP(idx, jedec_id),                                           \
 		IF_ENABLED(INST_HAS_EXT_MUTEX_GPIO(idx), (.ext_mutex = &ext_mutex_##idx, ))        \
 			IF_ENABLED(INST_HAS_SPI_CLK_GPIO(idx), (.spi_clk = &spi_clk_##idx, ))      \
 				IF_ENABLED(INST_HAS_EXT_MUTEX_GPIO(idx),                           \
 					   (.ext_mutex_role =                                      \
-						    DT_INST_ENUM_IDX(idx, ext_mutex_role), ))};    \
+						    DT_INST_ENUM_IDX(idx, ext_mutex_role), ))      \
+		IF_ENABLED(CONFIG_SPI_FLASH_EN25_EXT_MUTEX_HANDSHAKE,                              \
+			   (IF_ENABLED(INST_HAS_EXT_REQUEST_GPIO(idx),                             \
+				       (.ext_request = &ext_request_##idx, ))                      \
+			    IF_ENABLED(INST_HAS_EXT_GRANT_GPIO(idx),                               \
+				       (.ext_grant = &ext_grant_##idx, ))                          \
+			    .ext_master = DT_INST_ENUM_IDX_OR(idx, ext_mutex_role, 0) ==           \
+					  EXT_MUTEX_ROLE_MASTER, ))};                              \
 	IF_ENABLED(CONFIG_FLASH_PAGE_LAYOUT,                                                       \
 		   (BUILD_ASSERT((INST_##idx##_PAGES * DT_INST_PROP(idx, erase_sector_size)) ==    \
 					 INST_##idx##_BYTES,                                       \
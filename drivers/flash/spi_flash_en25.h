@@ -0,0 +1,936 @@
+/*
+ * COPYRIGHT NOTICE: (c) 2023 Irnas.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SPI_FLASH_EN25_H
+#define SPI_FLASH_EN25_H
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Check whether a device is an instance of this driver
+ *
+ * The extended API may only be called on such devices.
+ *
+ * @param[in] dev The device, can be NULL
+ *
+ * @retval true if @p dev is an EN25 instance
+ * @retval false otherwise
+ */
+bool spi_flash_en25_is_en25(const struct device *dev);
+
+/**
+ * @brief Path taken by spi_flash_en25_update()
+ *
+ * The values are ordered by cost, so for updates that span several sectors the most expensive
+ * path taken in any of them is reported.
+ */
+enum spi_flash_en25_update_path {
+	/** Flash already contained the requested data, nothing was written. */
+	SPI_FLASH_EN25_UPDATE_UNCHANGED,
+	/** New data only cleared bits, so it was programmed directly. */
+	SPI_FLASH_EN25_UPDATE_IN_PLACE,
+	/** At least one sector had to be erased and rewritten, or was discarded. */
+	SPI_FLASH_EN25_UPDATE_ERASED,
+};
+
+/**
+ * @brief Update a region of flash without requiring it to be erased beforehand
+ *
+ * For every affected erase sector the current contents are compared with the new data. If the
+ * new data only clears bits (new & old == new) it is programmed in place. Otherwise the sector is
+ * read into a driver owned buffer, merged with the new data, erased and written back.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region to update
+ * @param[in] data The new data
+ * @param[in] len Number of bytes to update
+ * @param[out] path Most expensive path taken, can be NULL
+ *
+ * @retval 0 on success
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval negative errno code on other failure
+ */
+int spi_flash_en25_update(const struct device *dev, off_t offset, const void *data, size_t len,
+			  enum spi_flash_en25_update_path *path);
+
+/**
+ * @brief Callback used by spi_flash_en25_digest() to feed data to a digest context
+ *
+ * @param[in] data Chunk of flash data
+ * @param[in] len Length of the chunk
+ * @param[in] user_data User data passed to spi_flash_en25_digest()
+ *
+ * @retval 0 to continue
+ * @retval negative errno code to abort the digest
+ */
+typedef int (*spi_flash_en25_digest_cb_t)(const uint8_t *data, size_t len, void *user_data);
+
+/**
+ * @brief Feed a flash region to a digest without a caller side buffer
+ *
+ * The region is read in large chunks through two driver owned buffers. When CONFIG_SPI_ASYNC is
+ * enabled, the next chunk is transferred while the callback processes the previous one.
+ *
+ * The device is locked for the whole duration, so the callback must not call into the driver.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region
+ * @param[in] len Length of the region
+ * @param[in] update Called for every chunk in order
+ * @param[in] user_data Passed to @p update
+ *
+ * @retval 0 on success
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval negative errno code on other failure or the error returned by @p update
+ */
+int spi_flash_en25_digest(const struct device *dev, off_t offset, size_t len,
+			  spi_flash_en25_digest_cb_t update, void *user_data);
+
+/**
+ * @brief Calculate the IEEE CRC32 of a flash region
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region
+ * @param[in] len Length of the region
+ * @param[in,out] crc CRC to continue from, set it to 0 to start a new checksum
+ *
+ * @retval 0 on success
+ * @retval negative errno code on failure
+ */
+int spi_flash_en25_crc32(const struct device *dev, off_t offset, size_t len, uint32_t *crc);
+
+/**
+ * @brief Calculate the SHA-256 hash of a flash region
+ *
+ * Only available with CONFIG_TINYCRYPT_SHA256.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region
+ * @param[in] len Length of the region
+ * @param[out] hash Buffer of 32 bytes for the resulting hash
+ *
+ * @retval 0 on success
+ * @retval negative errno code on failure
+ */
+int spi_flash_en25_sha256(const struct device *dev, off_t offset, size_t len, uint8_t *hash);
+
+/**
+ * @brief Write data and read every page back to compare it with the source
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset to write to, the region must be erased
+ * @param[in] data Data to write
+ * @param[in] len Number of bytes to write
+ *
+ * @retval 0 on success
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval -EIO if the data read back does not match or the SPI transfer failed
+ */
+int spi_flash_en25_write_verify(const struct device *dev, off_t offset, const void *data,
+				size_t len);
+
+/**
+ * @brief Copy a region to another region of the same device
+ *
+ * The source is read in chunks of CONFIG_SPI_FLASH_EN25_STREAM_CHUNK_SIZE bytes and the pages of
+ * every chunk are programmed back to back, polling for completion instead of sleeping.
+ *
+ * @param[in] dev The flash device
+ * @param[in] src Offset of the source region
+ * @param[in] dst Offset of the destination region, must not overlap the source
+ * @param[in] len Number of bytes to copy
+ * @param[in] erase_dst If true, the destination is erased first using the largest erase commands
+ *		possible. @p dst and @p len must then be multiples of the erase sector size.
+ *		Otherwise the destination must already be erased.
+ *
+ * @retval 0 on success
+ * @retval -ENODEV if a region is outside of the flash
+ * @retval -EINVAL if the regions overlap or are not aligned for erasing
+ * @retval negative errno code on other failure
+ */
+int spi_flash_en25_copy(const struct device *dev, off_t src, off_t dst, size_t len, bool erase_dst);
+
+/**
+ * @brief Check whether a region is erased
+ *
+ * The region is compared a word at a time and the scan stops at the first byte that is not
+ * erased. The driver remembers which sectors were found erased (or were erased by it), so later
+ * checks of those sectors do not need to read the flash.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region
+ * @param[in] len Length of the region
+ * @param[out] blank Set to true if every byte of the region is erased
+ *
+ * @retval 0 on success
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval negative errno code on other failure
+ */
+int spi_flash_en25_is_blank(const struct device *dev, off_t offset, size_t len, bool *blank);
+
+/**
+ * @brief Find the first byte in a region that is not erased
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region
+ * @param[in] len Length of the region
+ * @param[out] found Offset of the first byte that is not erased
+ *
+ * @retval 0 on success
+ * @retval -ENOENT if the whole region is erased
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval negative errno code on other failure
+ */
+int spi_flash_en25_find_non_blank(const struct device *dev, off_t offset, size_t len,
+				  off_t *found);
+
+/**
+ * @brief Find the first erased unit in a region
+ *
+ * Useful for finding the end of a log, with @p unit being the size of a record slot or page.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region, units are aligned relative to it
+ * @param[in] len Length of the region
+ * @param[in] unit Size of the unit that must be completely erased
+ * @param[out] found Offset of the first erased unit
+ *
+ * @retval 0 on success
+ * @retval -ENOENT if no unit in the region is completely erased
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval -EINVAL if @p unit is 0
+ * @retval negative errno code on other failure
+ */
+int spi_flash_en25_find_blank(const struct device *dev, off_t offset, size_t len, size_t unit,
+			      off_t *found);
+
+/**
+ * @brief Mark sectors as free, to be erased later
+ *
+ * The sectors are erased in the background once the device has been idle for
+ * CONFIG_SPI_FLASH_EN25_DISCARD_IDLE_TIMEOUT milliseconds, using block erases where alignment
+ * allows. Writing to a discarded sector that was not erased yet erases it first. The contents of
+ * discarded sectors are undefined until they are written again. Discards are kept in RAM only and
+ * are lost on reset.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region, must be a multiple of the erase sector size
+ * @param[in] size Size of the region, must be a multiple of the erase sector size
+ *
+ * @retval 0 on success
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval -EINVAL if the region is not sector aligned
+ */
+int spi_flash_en25_discard(const struct device *dev, off_t offset, size_t size);
+
+/**
+ * @brief A range for spi_flash_en25_erase_list()
+ */
+struct spi_flash_en25_erase_range {
+	/** Offset of the range, must be a multiple of the erase sector size. */
+	off_t offset;
+	/** Size of the range, must be a multiple of the erase sector size. */
+	size_t size;
+	/** Set by spi_flash_en25_erase_list() to the result of erasing this range. */
+	int result;
+};
+
+/**
+ * @brief Erase several ranges at once
+ *
+ * The ranges are sorted by offset in place, then overlapping and adjacent ranges are merged and
+ * each merged run is erased with the largest erase commands its alignment allows. Everything runs
+ * under a single acquisition of the device and of the external mutex.
+ *
+ * Each range gets its own result: 0 if it was erased, -ENODEV if it is outside of the flash,
+ * -EINVAL if it is not sector aligned, -EIO if erasing it failed and -ECANCELED if it was not
+ * attempted because an earlier run failed.
+ *
+ * @param[in] dev The flash device
+ * @param[in,out] ranges Ranges to erase
+ * @param[in] count Number of ranges
+ * @param[out] busy_us Time spent erasing, may be NULL
+ *
+ * @retval 0 if all ranges were erased
+ * @retval The first non-zero range result otherwise, in sorted order
+ */
+int spi_flash_en25_erase_list(const struct device *dev, struct spi_flash_en25_erase_range *ranges,
+			      size_t count, uint32_t *busy_us);
+
+/**
+ * @brief Erase and program counters of one erase sector
+ *
+ * Counters saturate at the width selected with CONFIG_SPI_FLASH_EN25_HEATMAP_COUNTER_8,
+ * CONFIG_SPI_FLASH_EN25_HEATMAP_COUNTER_16 or CONFIG_SPI_FLASH_EN25_HEATMAP_COUNTER_32.
+ */
+struct spi_flash_en25_heatmap_entry {
+	/** Erase commands that covered the sector, including block and chip erases. */
+	uint32_t erases;
+	/** Page program commands. */
+	uint32_t programs;
+	/** Bytes programmed. */
+	uint32_t bytes;
+};
+
+/**
+ * @brief Totals over all sectors
+ */
+struct spi_flash_en25_heatmap_summary {
+	/** Number of erase sectors. */
+	uint32_t sectors;
+	/** Size of an erase sector in bytes. */
+	uint32_t sector_size;
+	/** Bytes passed to flash_write(). */
+	uint64_t bytes_requested;
+	/** Bytes programmed by all operations, including read-modify-write and copies. */
+	uint64_t bytes_programmed;
+	/** bytes_programmed per byte requested, in thousandths. 0 if nothing was requested. */
+	uint32_t write_amplification_milli;
+	/** Sum of the erase counters. */
+	uint64_t total_erases;
+	/** Most erased sector and its erase count. */
+	uint32_t hottest_sector;
+	uint32_t max_erases;
+	/** Sectors with at least one saturated counter. */
+	uint32_t saturated;
+};
+
+/**
+ * @brief Read the counters of a range of erase sectors
+ *
+ * @param[in] dev The flash device
+ * @param[in] first_sector Index of the first sector
+ * @param[out] entries Counters, one per sector
+ * @param[in] count Number of sectors
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if the range is outside of the flash
+ */
+int spi_flash_en25_heatmap_get(const struct device *dev, uint32_t first_sector,
+			       struct spi_flash_en25_heatmap_entry *entries, size_t count);
+
+/**
+ * @brief Get the totals of the counters, including the write amplification
+ *
+ * @param[in] dev The flash device
+ * @param[out] summary Totals
+ *
+ * @retval 0 on success
+ */
+int spi_flash_en25_heatmap_summary_get(const struct device *dev,
+				       struct spi_flash_en25_heatmap_summary *summary);
+
+/**
+ * @brief Clear all counters of a device
+ *
+ * @param[in] dev The flash device
+ */
+void spi_flash_en25_heatmap_reset(const struct device *dev);
+
+/**
+ * @brief QoS classes, in order of priority
+ */
+enum spi_flash_en25_qos_class {
+	/** Latency sensitive accesses, served before all other classes. */
+	SPI_FLASH_EN25_QOS_HIGH,
+	/** Default class of threads that are not attached to a class. */
+	SPI_FLASH_EN25_QOS_NORMAL,
+	/** Bulk transfers, served when no other class is waiting. */
+	SPI_FLASH_EN25_QOS_BULK,
+
+	SPI_FLASH_EN25_QOS_CLASS_COUNT,
+};
+
+/**
+ * @brief Per-class QoS statistics
+ *
+ * Requests are split into chunks, an operation is a single chunk.
+ */
+struct spi_flash_en25_qos_stats {
+	/** Number of operations served. */
+	uint32_t ops;
+	/** Number of bytes read or written. */
+	uint64_t bytes;
+	/** Time spent waiting for budget, in milliseconds. */
+	uint32_t throttled_ms;
+	/** Total time spent waiting for the device once budget was available. */
+	uint64_t total_wait_us;
+	/** Longest time spent waiting for the device once budget was available. */
+	uint32_t max_wait_us;
+};
+
+/**
+ * @brief Attach a thread to a QoS class
+ *
+ * Threads that are not attached to a class use SPI_FLASH_EN25_QOS_NORMAL. The class applies to
+ * flash_read(), flash_write() and flash_erase() called by the thread.
+ *
+ * @param[in] dev The flash device
+ * @param[in] thread The thread
+ * @param[in] cls The class, SPI_FLASH_EN25_QOS_NORMAL detaches the thread
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p cls is not valid
+ * @retval -ENOMEM if CONFIG_SPI_FLASH_EN25_QOS_MAX_THREADS threads are already attached
+ */
+int spi_flash_en25_qos_attach(const struct device *dev, k_tid_t thread,
+			      enum spi_flash_en25_qos_class cls);
+
+/**
+ * @brief Set the budget of a QoS class
+ *
+ * Budgets are enforced with token buckets that hold up to CONFIG_SPI_FLASH_EN25_QOS_BURST_MS
+ * worth of budget. Erases only use the operation budget.
+ *
+ * @param[in] dev The flash device
+ * @param[in] cls The class
+ * @param[in] bytes_per_sec Bytes read or written per second, 0 for unlimited
+ * @param[in] ops_per_sec Operations per second, 0 for unlimited
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p cls is not valid
+ */
+int spi_flash_en25_qos_set_budget(const struct device *dev, enum spi_flash_en25_qos_class cls,
+				  uint32_t bytes_per_sec, uint32_t ops_per_sec);
+
+/**
+ * @brief Get the statistics of a QoS class
+ *
+ * @param[in] dev The flash device
+ * @param[in] cls The class
+ * @param[out] stats Statistics
+ * @param[in] reset Clear the statistics after reading them
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p cls is not valid
+ */
+int spi_flash_en25_qos_get_stats(const struct device *dev, enum spi_flash_en25_qos_class cls,
+				 struct spi_flash_en25_qos_stats *stats, bool reset);
+
+/**
+ * @brief Read a region into a driver owned buffer and borrow it
+ *
+ * The buffer stays valid and unchanged until it is returned with spi_flash_en25_read_release().
+ * Writes and erases of the region are not blocked while it is borrowed, but are reported by
+ * spi_flash_en25_read_release().
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region
+ * @param[in] len Length of the region, at most CONFIG_SPI_FLASH_EN25_BORROW_MAX_LEN
+ * @param[out] data Pointer to the borrowed buffer
+ * @param[in] timeout How long to wait for a free buffer
+ *
+ * @retval 0 on success
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval -EINVAL if @p len is 0 or too large
+ * @retval -ENOMEM if no buffer became free in time
+ * @retval negative errno code on other failure
+ */
+int spi_flash_en25_read_borrow(const struct device *dev, off_t offset, size_t len,
+			       const void **data, k_timeout_t timeout);
+
+/**
+ * @brief Return a buffer borrowed with spi_flash_en25_read_borrow()
+ *
+ * @param[in] dev The flash device
+ * @param[in] data The borrowed buffer
+ *
+ * @retval 0 on success
+ * @retval -ESTALE if the region was written or erased while borrowed, the buffer held the old
+ *	   contents
+ * @retval -EINVAL if @p data is not a borrowed buffer
+ */
+int spi_flash_en25_read_release(const struct device *dev, const void *data);
+
+/**
+ * @brief Callback used by spi_flash_en25_bulk_read() to hand a chunk to the consumer
+ *
+ * The chunk is owned by the consumer from this call on, whatever the return value, and has to be
+ * returned with spi_flash_en25_bulk_read_release(). That may happen within the callback or later,
+ * e.g. from the completion interrupt of a transfer that sends the chunk on.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Flash offset of the chunk
+ * @param[in] chunk The chunk, in a driver owned buffer
+ * @param[in] len Length of the chunk
+ * @param[in] user_data User data passed to spi_flash_en25_bulk_read()
+ *
+ * @retval 0 to continue
+ * @retval positive value to stop the read without an error
+ * @retval negative errno code to abort the read with that error
+ */
+typedef int (*spi_flash_en25_bulk_read_cb_t)(const struct device *dev, off_t offset,
+					     const uint8_t *chunk, size_t len, void *user_data);
+
+/**
+ * @brief Read a region through the driver owned bulk read buffers
+ *
+ * The region is read in chunks of CONFIG_SPI_FLASH_EN25_BULK_READ_CHUNK_SIZE bytes, in order,
+ * under a single acquisition of the device and the external mutex. With SPI_ASYNC the next chunk
+ * is being read while the callback processes the previous one. When the consumer holds all
+ * CONFIG_SPI_FLASH_EN25_BULK_READ_BUFS buffers, the read waits until one is released. The device
+ * and the external mutex stay held during that wait, so it has to be bounded.
+ *
+ * @param[in] dev The flash device
+ * @param[in] offset Offset of the region
+ * @param[in] len Length of the region
+ * @param[in] cb Called for every chunk
+ * @param[in] user_data Passed to @p cb
+ * @param[in] timeout How long to wait for the consumer to release a buffer, K_FOREVER is rejected
+ *
+ * @retval 0 on success or if @p cb stopped the read
+ * @retval -ENODEV if the region is outside of the flash
+ * @retval -EINVAL if @p cb is NULL or @p timeout is K_FOREVER
+ * @retval -EAGAIN if the consumer did not release a buffer in time
+ * @retval negative errno code returned by @p cb or on other failure
+ */
+int spi_flash_en25_bulk_read(const struct device *dev, off_t offset, size_t len,
+			     spi_flash_en25_bulk_read_cb_t cb, void *user_data,
+			     k_timeout_t timeout);
+
+/**
+ * @brief Return a chunk handed out by spi_flash_en25_bulk_read()
+ *
+ * May be called from an ISR.
+ *
+ * @param[in] dev The flash device
+ * @param[in] chunk The chunk
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if @p chunk is not a held bulk read buffer
+ */
+int spi_flash_en25_bulk_read_release(const struct device *dev, const void *chunk);
+
+/**
+ * @brief Power and activity states tracked by the driver
+ */
+enum spi_flash_en25_power_state {
+	/** Powered up with no operation in progress. */
+	SPI_FLASH_EN25_POWER_STANDBY,
+	/** An operation holds the device, SPI transfers are in progress. */
+	SPI_FLASH_EN25_POWER_ACTIVE,
+	/** Waiting for a program or erase to complete. */
+	SPI_FLASH_EN25_POWER_BUSY,
+	/** Entering or leaving deep power-down. */
+	SPI_FLASH_EN25_POWER_TRANSITION,
+	/** In deep power-down. */
+	SPI_FLASH_EN25_POWER_DPD,
+
+	SPI_FLASH_EN25_POWER_STATE_COUNT,
+};
+
+/**
+ * @brief Power statistics of a device
+ */
+struct spi_flash_en25_power_stats {
+	/** Time spent in each state, indexed by enum spi_flash_en25_power_state. */
+	uint64_t residency_us[SPI_FLASH_EN25_POWER_STATE_COUNT];
+	/** Number of wake-ups from deep power-down. */
+	uint32_t wake_count;
+	/** Longest wake-up, from issuing the resume command until the chip is ready. */
+	uint32_t max_wake_latency_us;
+	/** Total time spent waking up. */
+	uint64_t total_wake_latency_us;
+	/** Estimated charge drawn, based on the currents set in devicetree. */
+	uint64_t charge_uc;
+	/** Estimated energy used, 0 if supply-voltage-mv is not set in devicetree. */
+	uint64_t energy_uj;
+};
+
+/**
+ * @brief Get the power statistics of a device
+ *
+ * Residency is counted from boot or the last reset of the statistics. Use of the flash by the
+ * other MCU sharing it through the external mutex is not visible to the driver.
+ *
+ * @param[in] dev The flash device
+ * @param[out] stats Statistics
+ * @param[in] reset Clear the statistics after reading them
+ *
+ * @retval 0 on success
+ */
+int spi_flash_en25_power_stats_get(const struct device *dev,
+				   struct spi_flash_en25_power_stats *stats, bool reset);
+
+/**
+ * @brief External mutex handshake statistics, as seen from this MCU
+ */
+struct spi_flash_en25_ext_mutex_stats {
+	/** Operations that had to wait for the other MCU to hand over the flash. */
+	uint32_t waits;
+	/** Total and longest time operations waited for the flash. */
+	uint64_t wait_total_us;
+	uint32_t wait_max_us;
+	/** Requests that timed out. */
+	uint32_t timeouts;
+	/** Times the flash was handed to the other MCU. */
+	uint32_t handoffs;
+	/** Total and longest time from a request of the other MCU until it was handed the flash. */
+	uint64_t peer_wait_total_us;
+	uint32_t peer_wait_max_us;
+};
+
+/**
+ * @brief Get the external mutex handshake statistics of a device
+ *
+ * @param[in] dev The flash device
+ * @param[out] stats Statistics
+ * @param[in] reset Clear the statistics after reading them
+ *
+ * @retval 0 on success
+ * @retval -ENOTSUP if the device does not use the request/grant handshake
+ */
+int spi_flash_en25_ext_mutex_stats_get(const struct device *dev,
+				       struct spi_flash_en25_ext_mutex_stats *stats, bool reset);
+
+/**
+ * @brief Demand paging backing store statistics
+ */
+struct spi_flash_en25_backing_store_stats {
+	/** Slots in the backing store partition and slots holding a data page. */
+	uint32_t slots;
+	uint32_t slots_used;
+	/** Pages read from and staged for writing to the backing store. */
+	uint32_t page_ins;
+	uint32_t page_outs;
+	/** Page-ins served from pages that were staged but not written yet. */
+	uint32_t batch_hits;
+	/** Batches of staged pages written to the flash. */
+	uint32_t flushes;
+	/** Total and longest time spent copying a page in. */
+	uint64_t page_in_total_us;
+	uint32_t page_in_max_us;
+};
+
+/**
+ * @brief Get the statistics of the demand paging backing store
+ *
+ * @param[out] stats Statistics
+ *
+ * @retval 0 on success
+ */
+int spi_flash_en25_backing_store_stats_get(struct spi_flash_en25_backing_store_stats *stats);
+
+/**
+ * @brief Index entry of a blob
+ */
+struct spi_flash_en25_blob_info {
+	/** Caller chosen ID. */
+	uint32_t id;
+	/** Uncompressed length. */
+	uint32_t len;
+	/** Bytes taken in flash, including framing but not the padding to the next page. */
+	uint32_t stored_len;
+	/** Offset of the blob header in flash. */
+	off_t offset;
+};
+
+/**
+ * @brief Compressed blob store in a region of an EN25 flash
+ *
+ * Define with SPI_FLASH_EN25_BLOB_STORE_DEFINE() and initialize with
+ * spi_flash_en25_blob_store_init(). Fields are private.
+ */
+struct spi_flash_en25_blob_store {
+	const struct device *dev;
+	off_t offset;
+	size_t size;
+	struct spi_flash_en25_blob_info *index;
+	size_t index_size;
+	size_t count;
+	uint8_t *page;
+	size_t page_size;
+	off_t next;
+	bool ready;
+};
+
+/**
+ * @brief Define a blob store
+ *
+ * @param name Name of the store variable
+ * @param node_id Devicetree node of the EN25 flash
+ * @param offset_ Offset of the region, aligned to erase-sector-size
+ * @param size_ Size of the region, a multiple of erase-sector-size
+ * @param max_blobs Number of blobs the index can hold
+ */
+#define SPI_FLASH_EN25_BLOB_STORE_DEFINE(name, node_id, offset_, size_, max_blobs)                \
+	static struct spi_flash_en25_blob_info name##_index[max_blobs];                            \
+	static uint8_t name##_page[DT_PROP(node_id, write_sector_size)];                           \
+	static struct spi_flash_en25_blob_store name = {                                           \
+		.dev = DEVICE_DT_GET(node_id),                                                     \
+		.offset = (offset_),                                                               \
+		.size = (size_),                                                                   \
+		.index = name##_index,                                                             \
+		.index_size = (max_blobs),                                                         \
+		.page = name##_page,                                                               \
+		.page_size = sizeof(name##_page),                                                  \
+		.next = (offset_),                                                                 \
+	}
+
+/**
+ * @brief Scan the region of a blob store and build its index
+ *
+ * Blobs whose write was interrupted are skipped.
+ *
+ * @param[in] store The blob store
+ *
+ * @retval 0 on success
+ * @retval -ENOMEM if the region holds more blobs than the index
+ * @retval -EINVAL if the region is not aligned to write sectors
+ */
+int spi_flash_en25_blob_store_init(struct spi_flash_en25_blob_store *store);
+
+/**
+ * @brief Compress and store a blob
+ *
+ * The blob is compressed in chunks of CONFIG_SPI_FLASH_EN25_BLOB_CHUNK_SIZE bytes, chunks that do
+ * not compress are stored as they are. The compressed stream is programmed in whole write sectors
+ * and the blob only becomes valid once all of it is written. A blob with the same ID is replaced.
+ *
+ * @param[in] store The blob store
+ * @param[in] id Blob ID
+ * @param[in] data Blob contents
+ * @param[in] len Blob length
+ *
+ * @retval 0 on success
+ * @retval -ENOSPC if the region does not have room for the blob (in the worst case)
+ * @retval -ENOMEM if the index is full
+ * @retval -EACCES if the store was not initialized or cleared first
+ */
+int spi_flash_en25_blob_write(struct spi_flash_en25_blob_store *store, uint32_t id,
+			      const void *data, size_t len);
+
+/**
+ * @brief Read and decompress a blob
+ *
+ * @param[in] store The blob store
+ * @param[in] id Blob ID
+ * @param[out] buf Buffer for the uncompressed blob
+ * @param[in] buf_len Size of the buffer
+ *
+ * @return Length of the blob on success, negative error code otherwise
+ * @retval -ENOENT if there is no blob with this ID
+ * @retval -ENOMEM if the buffer is too small
+ * @retval -EIO if the stored blob is corrupted
+ */
+int spi_flash_en25_blob_read(struct spi_flash_en25_blob_store *store, uint32_t id, void *buf,
+			     size_t buf_len);
+
+/**
+ * @brief Get the index entry of a blob
+ *
+ * @retval 0 on success
+ * @retval -ENOENT if there is no blob with this ID
+ */
+int spi_flash_en25_blob_info_get(struct spi_flash_en25_blob_store *store, uint32_t id,
+				 struct spi_flash_en25_blob_info *info);
+
+/**
+ * @brief Delete a blob
+ *
+ * The blob is marked as deleted in flash. Its space is only reclaimed by
+ * spi_flash_en25_blob_clear().
+ *
+ * @retval 0 on success
+ * @retval -ENOENT if there is no blob with this ID
+ */
+int spi_flash_en25_blob_delete(struct spi_flash_en25_blob_store *store, uint32_t id);
+
+/**
+ * @brief Erase the region of a blob store and drop all blobs
+ *
+ * @retval 0 on success
+ */
+int spi_flash_en25_blob_clear(struct spi_flash_en25_blob_store *store);
+
+/**
+ * @brief Get the number of bytes left for new blobs
+ */
+size_t spi_flash_en25_blob_free_get(struct spi_flash_en25_blob_store *store);
+
+/**
+ * @brief Index entry of a key-value store key
+ */
+struct spi_flash_en25_kv_entry {
+	uint32_t key;
+	/** Offset of the record in flash. */
+	uint32_t offset;
+	/** Length of the value. */
+	uint16_t len;
+};
+
+/**
+ * @brief Key-value store in a region of an EN25 flash
+ *
+ * Define with SPI_FLASH_EN25_KV_STORE_DEFINE() and initialize with
+ * spi_flash_en25_kv_store_init(). Fields are private.
+ */
+struct spi_flash_en25_kv_store {
+	const struct device *dev;
+	off_t offset;
+	size_t size;
+	size_t sector_size;
+	uint8_t *page;
+	size_t page_size;
+	struct spi_flash_en25_kv_entry *index;
+	size_t index_size;
+	size_t max_keys;
+	size_t count;
+	size_t head;
+	off_t next;
+	uint32_t seq;
+	struct k_mutex lock;
+};
+
+/**
+ * @brief Define a key-value store
+ *
+ * The hash index takes about 18 bytes of RAM per key.
+ *
+ * @param name Name of the store variable
+ * @param node_id Devicetree node of the EN25 flash
+ * @param offset_ Offset of the region, aligned to erase-sector-size
+ * @param size_ Size of the region, at least two erase sectors
+ * @param max_keys_ Number of keys the index can hold
+ */
+#define SPI_FLASH_EN25_KV_STORE_DEFINE(name, node_id, offset_, size_, max_keys_)                  \
+	static struct spi_flash_en25_kv_entry name##_index[(max_keys_) + (max_keys_) / 2 + 1];     \
+	static uint8_t name##_page[DT_PROP(node_id, write_sector_size)];                           \
+	static struct spi_flash_en25_kv_store name = {                                             \
+		.dev = DEVICE_DT_GET(node_id),                                                     \
+		.offset = (offset_),                                                               \
+		.size = (size_),                                                                   \
+		.sector_size = DT_PROP(node_id, erase_sector_size),                                \
+		.page = name##_page,                                                               \
+		.page_size = sizeof(name##_page),                                                  \
+		.index = name##_index,                                                             \
+		.index_size = ARRAY_SIZE(name##_index),                                            \
+		.max_keys = (max_keys_),                                                           \
+	}
+
+/**
+ * @brief Mount a key-value store
+ *
+ * Reads the region once from the oldest record to the newest to build the index, and finishes a
+ * compaction interrupted by a reset. A region without a store is erased.
+ *
+ * @param[in] store The key-value store
+ *
+ * @retval 0 on success
+ * @retval -ENOMEM if the region holds more keys than the index
+ * @retval -EINVAL if the region is not aligned to erase sectors or is smaller than two
+ */
+int spi_flash_en25_kv_store_init(struct spi_flash_en25_kv_store *store);
+
+/**
+ * @brief Write the value of a key
+ *
+ * Appends one record, starting on a write sector boundary. When the erase sector being written is
+ * full, the store moves to the next one, copying the live records of the oldest sector there and
+ * erasing it.
+ *
+ * @param[in] store The key-value store
+ * @param[in] key Key, any value except UINT32_MAX
+ * @param[in] data Value
+ * @param[in] len Length of the value, at most an erase sector minus a write sector and 12 bytes
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if the key is invalid or the value too long
+ * @retval -ENOMEM if the index is full
+ * @retval -ENOSPC if the live records fill the region
+ */
+int spi_flash_en25_kv_write(struct spi_flash_en25_kv_store *store, uint32_t key, const void *data,
+			    size_t len);
+
+/**
+ * @brief Read the value of a key
+ *
+ * Takes a single flash read.
+ *
+ * @param[in] store The key-value store
+ * @param[in] key Key
+ * @param[out] buf Buffer for the value
+ * @param[in] buf_len Size of the buffer
+ *
+ * @return Length of the value on success, negative error code otherwise
+ * @retval -ENOENT if the key is not in the store
+ * @retval -ENOMEM if the buffer is too small
+ */
+int spi_flash_en25_kv_read(struct spi_flash_en25_kv_store *store, uint32_t key, void *buf,
+			   size_t buf_len);
+
+/**
+ * @brief Delete a key
+ *
+ * @retval 0 on success
+ * @retval -ENOENT if the key is not in the store
+ */
+int spi_flash_en25_kv_delete(struct spi_flash_en25_kv_store *store, uint32_t key);
+
+/**
+ * @brief Get the number of keys in the store
+ */
+size_t spi_flash_en25_kv_count_get(struct spi_flash_en25_kv_store *store);
+
+/**
+ * @brief Write a block to the emergency save region within a deadline
+ *
+ * Meant for saving state on brownout. The block is written to the region given by the
+ * emergency-save-region devicetree property, which must be erased (armed). An operation holding
+ * the flash gives up at its next status poll and fails, a program or erase it left running on the
+ * chip is abandoned with a reset. The chip is then polled every
+ * CONFIG_SPI_FLASH_EN25_EMERGENCY_POLL_US microseconds without sleeping.
+ *
+ * With an external mutex, the save only proceeds while the other MCU does not hold the flash. Must
+ * be called from a thread, not an interrupt handler.
+ *
+ * @param[in] dev The flash device
+ * @param[in] data Block to save
+ * @param[in] len Length of the block, at most the size of the region
+ * @param[in] deadline_us Time the whole block must be written in, in microseconds
+ * @param[out] written Number of bytes programmed, in whole write sectors except for the last one
+ *
+ * @retval 0 if the whole block was written within the deadline
+ * @retval -ETIMEDOUT if the deadline passed, @p written tells how much was saved
+ * @retval -EAGAIN if the region is not armed
+ * @retval -EINVAL if the block does not fit the region
+ * @retval -ENOTSUP if the device has no emergency save region
+ * @retval negative errno code on other failure
+ */
+int spi_flash_en25_emergency_save(const struct device *dev, const void *data, size_t len,
+				  uint32_t deadline_us, size_t *written);
+
+/**
+ * @brief Erase the emergency save region in the background
+ *
+ * A region that holds a snapshot, including one found at boot, is kept until this is called, so
+ * the snapshot can be read with flash_read() first. The region is erased on the work queue of the
+ * driver, skipping the erase if it already is.
+ *
+ * @param[in] dev The flash device
+ *
+ * @retval 0 on success
+ * @retval -EBUSY if an emergency save is in progress
+ * @retval -ENOTSUP if the device has no emergency save region
+ */
+int spi_flash_en25_emergency_rearm(const struct device *dev);
+
+/**
+ * @brief Check whether the emergency save region is erased and ready for a save
+ */
+bool spi_flash_en25_emergency_is_armed(const struct device *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPI_FLASH_EN25_H */
@@ -0,0 +1,480 @@
+/*
+ * COPYRIGHT NOTICE: (c) 2023 Irnas.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Log structured store of LZ4 compressed blobs. Every blob starts on a write sector boundary with a
+ * header, followed by its chunks. A chunk is a 16-bit length and the compressed data, or the raw
+ * data if compressing did not make it smaller. The stored length and CRC in the header stay erased
+ * until all chunks are programmed, which commits the blob.
+ */
+
+#include "spi_flash_en25.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <lz4.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+LOG_MODULE_REGISTER(spi_flash_en25_blob, CONFIG_FLASH_LOG_LEVEL);
+
+#define BLOB_MAGIC  0x424C4F42
+#define BLOB_ERASED UINT32_MAX
+
+#define CHUNK_SIZE	 CONFIG_SPI_FLASH_EN25_BLOB_CHUNK_SIZE
+#define CHUNK_BOUND	 LZ4_COMPRESSBOUND(CHUNK_SIZE)
+/* Set in the chunk length for chunks stored uncompressed */
+#define CHUNK_RAW	 BIT(15)
+#define CHUNK_HEADER_LEN sizeof(uint16_t)
+
+BUILD_ASSERT(CHUNK_BOUND < CHUNK_RAW, "Chunk length does not fit the chunk header");
+
+struct blob_header {
+	uint32_t magic;
+	uint32_t id;
+	uint32_t len;
+	/* Length and CRC32 of the chunks, erased until the blob is committed */
+	uint32_t stored_len;
+	uint32_t crc;
+	/* Erased until the blob is deleted */
+	uint8_t deleted;
+	uint8_t reserved[3];
+} __packed;
+
+/* Streams chunks into write sector sized programs */
+struct blob_writer {
+	struct spi_flash_en25_blob_store *store;
+	/* Flash offset of the page buffer and bytes in it */
+	off_t pos;
+	size_t fill;
+	/* Chunk bytes written so far and their CRC32 */
+	size_t stored;
+	uint32_t crc;
+};
+
+/* Compression state and buffers are shared by all stores */
+static K_MUTEX_DEFINE(blob_lock);
+static LZ4_stream_t blob_lz4;
+static uint8_t blob_chunk[CHUNK_BOUND];
+
+static off_t store_end(const struct spi_flash_en25_blob_store *store)
+{
+	return store->offset + (off_t)store->size;
+}
+
+static struct spi_flash_en25_blob_info *find(struct spi_flash_en25_blob_store *store, uint32_t id)
+{
+	for (size_t i = 0; i < store->count; i++) {
+		if (store->index[i].id == id) {
+			return &store->index[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int writer_put(struct blob_writer *w, const void *data, size_t len)
+{
+	struct spi_flash_en25_blob_store *store = w->store;
+	int err;
+
+	while (len) {
+		size_t n = MIN(len, store->page_size - w->fill);
+
+		memcpy(&store->page[w->fill], data, n);
+		w->fill += n;
+		data = (const uint8_t *)data + n;
+		len -= n;
+
+		if (w->fill == store->page_size) {
+			err = flash_write(store->dev, w->pos, store->page, store->page_size);
+			if (err) {
+				return err;
+			}
+			w->pos += store->page_size;
+			w->fill = 0;
+		}
+	}
+
+	return 0;
+}
+
+static int writer_put_chunk(struct blob_writer *w, const void *data, size_t len)
+{
+	w->crc = crc32_ieee_update(w->crc, data, len);
+	w->stored += len;
+
+	return writer_put(w, data, len);
+}
+
+/* Programs the last, partial page. The next blob starts on the following page. */
+static int writer_flush(struct blob_writer *w)
+{
+	int err = 0;
+
+	if (w->fill) {
+		err = flash_write(w->store->dev, w->pos, w->store->page, w->fill);
+		w->pos += w->store->page_size;
+		w->fill = 0;
+	}
+
+	return err;
+}
+
+static int mark_deleted(struct spi_flash_en25_blob_store *store, off_t offset)
+{
+	const uint8_t deleted = 0;
+
+	return flash_write(store->dev, offset + offsetof(struct blob_header, deleted), &deleted,
+			   sizeof(deleted));
+}
+
+int spi_flash_en25_blob_write(struct spi_flash_en25_blob_store *store, uint32_t id,
+			      const void *data, size_t len)
+{
+	const uint8_t *src = data;
+	struct blob_header hdr;
+	struct blob_writer w = {
+		.store = store,
+		.pos = store->next,
+	};
+	struct spi_flash_en25_blob_info *old;
+	/* Every chunk is stored raw at worst */
+	size_t worst_len = sizeof(hdr) + DIV_ROUND_UP(len, CHUNK_SIZE) * CHUNK_HEADER_LEN + len;
+	int err = 0;
+
+	memset(&hdr, 0xFF, sizeof(hdr));
+	hdr.magic = BLOB_MAGIC;
+	hdr.id = id;
+	hdr.len = len;
+
+	k_mutex_lock(&blob_lock, K_FOREVER);
+
+	/* Without the scan the region may hold blobs the next write would program over */
+	if (!store->ready) {
+		err = -EACCES;
+		goto out;
+	}
+
+	old = find(store, id);
+	if (!old && store->count == store->index_size) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	if (worst_len > (size_t)(store_end(store) - store->next)) {
+		err = -ENOSPC;
+		goto out;
+	}
+
+	err = writer_put(&w, &hdr, sizeof(hdr));
+
+	for (size_t done = 0; !err && done < len;) {
+		size_t n = MIN(CHUNK_SIZE, len - done);
+		int clen = LZ4_compress_fast_extState(&blob_lz4, (const char *)&src[done],
+						      (char *)blob_chunk, n, sizeof(blob_chunk), 1);
+		const uint8_t *chunk = blob_chunk;
+		uint16_t chunk_hdr = clen;
+
+		if (clen <= 0 || (size_t)clen >= n) {
+			chunk = &src[done];
+			clen = n;
+			chunk_hdr = CHUNK_RAW | n;
+		}
+
+		err = writer_put_chunk(&w, &chunk_hdr, sizeof(chunk_hdr));
+		if (!err) {
+			err = writer_put_chunk(&w, chunk, clen);
+		}
+
+		done += n;
+	}
+
+	if (!err) {
+		err = writer_flush(&w);
+	}
+
+	if (!err) {
+		const uint32_t commit[] = {w.stored, w.crc};
+		off_t commit_offset = store->next + offsetof(struct blob_header, stored_len);
+
+		err = flash_write(store->dev, commit_offset, commit, sizeof(commit));
+	}
+
+	if (err) {
+		/* The page that failed may be partly programmed, so it is not reused */
+		LOG_ERR("Writing blob %u failed: %d", id, err);
+		store->next = MIN(w.pos + (off_t)store->page_size, store_end(store));
+		goto out;
+	}
+
+	/* An older copy is deleted only after the new one is committed */
+	if (old) {
+		(void)mark_deleted(store, old->offset);
+	} else {
+		old = &store->index[store->count++];
+	}
+
+	old->id = id;
+	old->len = len;
+	old->stored_len = sizeof(hdr) + w.stored;
+	old->offset = store->next;
+
+	store->next = w.pos;
+
+out:
+	k_mutex_unlock(&blob_lock);
+
+	return err;
+}
+
+int spi_flash_en25_blob_read(struct spi_flash_en25_blob_store *store, uint32_t id, void *buf,
+			     size_t buf_len)
+{
+	const struct spi_flash_en25_blob_info *info;
+	uint8_t *dst = buf;
+	uint32_t crc = 0;
+	uint32_t expected_crc;
+	off_t pos;
+	int err;
+
+	k_mutex_lock(&blob_lock, K_FOREVER);
+
+	info = find(store, id);
+	if (!info) {
+		err = -ENOENT;
+		goto out;
+	}
+
+	if (buf_len < info->len) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	pos = info->offset + sizeof(struct blob_header);
+
+	for (size_t done = 0; done < info->len;) {
+		size_t n = MIN(CHUNK_SIZE, info->len - done);
+		uint16_t chunk_hdr;
+		size_t clen;
+
+		err = flash_read(store->dev, pos, &chunk_hdr, sizeof(chunk_hdr));
+		if (err) {
+			goto out;
+		}
+		crc = crc32_ieee_update(crc, (uint8_t *)&chunk_hdr, sizeof(chunk_hdr));
+		pos += sizeof(chunk_hdr);
+
+		clen = chunk_hdr & ~CHUNK_RAW;
+		if ((chunk_hdr & CHUNK_RAW) ? (clen != n) : (clen > sizeof(blob_chunk))) {
+			err = -EIO;
+			goto out;
+		}
+
+		/* Raw chunks go straight to the caller buffer */
+		err = flash_read(store->dev, pos, (chunk_hdr & CHUNK_RAW) ? &dst[done] : blob_chunk,
+				 clen);
+		if (err) {
+			goto out;
+		}
+
+		if (chunk_hdr & CHUNK_RAW) {
+			crc = crc32_ieee_update(crc, &dst[done], clen);
+		} else {
+			crc = crc32_ieee_update(crc, blob_chunk, clen);
+			if (LZ4_decompress_safe((const char *)blob_chunk, (char *)&dst[done], clen,
+						n) != n) {
+				err = -EIO;
+				goto out;
+			}
+		}
+
+		pos += clen;
+		done += n;
+	}
+
+	err = flash_read(store->dev, info->offset + offsetof(struct blob_header, crc),
+			 &expected_crc, sizeof(expected_crc));
+	if (err) {
+		goto out;
+	}
+
+	if (crc != expected_crc || pos - info->offset != info->stored_len) {
+		err = -EIO;
+		goto out;
+	}
+
+	err = info->len;
+
+out:
+	k_mutex_unlock(&blob_lock);
+
+	return err;
+}
+
+int spi_flash_en25_blob_info_get(struct spi_flash_en25_blob_store *store, uint32_t id,
+				 struct spi_flash_en25_blob_info *info)
+{
+	const struct spi_flash_en25_blob_info *entry;
+	int err = 0;
+
+	k_mutex_lock(&blob_lock, K_FOREVER);
+
+	entry = find(store, id);
+	if (entry) {
+		*info = *entry;
+	} else {
+		err = -ENOENT;
+	}
+
+	k_mutex_unlock(&blob_lock);
+
+	return err;
+}
+
+int spi_flash_en25_blob_delete(struct spi_flash_en25_blob_store *store, uint32_t id)
+{
+	struct spi_flash_en25_blob_info *entry;
+	int err;
+
+	k_mutex_lock(&blob_lock, K_FOREVER);
+
+	entry = find(store, id);
+	if (!entry) {
+		err = -ENOENT;
+		goto out;
+	}
+
+	err = mark_deleted(store, entry->offset);
+	if (!err) {
+		*entry = store->index[--store->count];
+	}
+
+out:
+	k_mutex_unlock(&blob_lock);
+
+	return err;
+}
+
+int spi_flash_en25_blob_clear(struct spi_flash_en25_blob_store *store)
+{
+	int err;
+
+	k_mutex_lock(&blob_lock, K_FOREVER);
+
+	err = flash_erase(store->dev, store->offset, store->size);
+	if (!err) {
+		store->count = 0;
+		store->next = store->offset;
+		store->ready = true;
+	}
+
+	k_mutex_unlock(&blob_lock);
+
+	return err;
+}
+
+size_t spi_flash_en25_blob_free_get(struct spi_flash_en25_blob_store *store)
+{
+	size_t free;
+
+	k_mutex_lock(&blob_lock, K_FOREVER);
+	free = store_end(store) - store->next;
+	k_mutex_unlock(&blob_lock);
+
+	return free;
+}
+
+/* Moves past the pages of an interrupted write, to the first erased page */
+static int skip_programmed(struct spi_flash_en25_blob_store *store, off_t *pos)
+{
+	int err;
+
+	for (*pos += store->page_size; *pos < store_end(store); *pos += store->page_size) {
+		bool erased = true;
+
+		err = flash_read(store->dev, *pos, store->page, store->page_size);
+		if (err) {
+			return err;
+		}
+
+		for (size_t i = 0; erased && i < store->page_size; i++) {
+			erased = store->page[i] == 0xFF;
+		}
+
+		if (erased) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static int index_add(struct spi_flash_en25_blob_store *store, const struct blob_header *hdr,
+		     off_t offset)
+{
+	/* A blob replaced right before a reset may still be there, the later copy wins */
+	struct spi_flash_en25_blob_info *entry = find(store, hdr->id);
+
+	if (!entry) {
+		if (store->count == store->index_size) {
+			return -ENOMEM;
+		}
+		entry = &store->index[store->count++];
+	}
+
+	entry->id = hdr->id;
+	entry->len = hdr->len;
+	entry->stored_len = sizeof(*hdr) + hdr->stored_len;
+	entry->offset = offset;
+
+	return 0;
+}
+
+int spi_flash_en25_blob_store_init(struct spi_flash_en25_blob_store *store)
+{
+	off_t pos = store->offset;
+	struct blob_header hdr;
+	int err = 0;
+
+	if ((store->offset % store->page_size) != 0 || (store->size % store->page_size) != 0) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&blob_lock, K_FOREVER);
+
+	store->count = 0;
+
+	while (!err && pos + (off_t)sizeof(hdr) <= store_end(store)) {
+		err = flash_read(store->dev, pos, &hdr, sizeof(hdr));
+		if (err || hdr.magic == BLOB_ERASED) {
+			break;
+		}
+
+		if (hdr.magic != BLOB_MAGIC || hdr.stored_len == BLOB_ERASED ||
+		    hdr.stored_len > store_end(store) - pos - sizeof(hdr)) {
+			LOG_WRN("Skipping incomplete blob at 0x%lx", (long)pos);
+			err = skip_programmed(store, &pos);
+			continue;
+		}
+
+		if (hdr.deleted == 0xFF) {
+			err = index_add(store, &hdr, pos);
+		}
+
+		pos = ROUND_UP(pos + sizeof(hdr) + hdr.stored_len, store->page_size);
+	}
+
+	store->next = MIN(pos, store_end(store));
+	store->ready = !err;
+
+	k_mutex_unlock(&blob_lock);
+
+	return err;
+}
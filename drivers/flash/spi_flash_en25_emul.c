@@ -0,0 +1,231 @@
+/*
+ * COPYRIGHT NOTICE: (c) 2023 Irnas.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Emulated EN25 chip on an emulated SPI bus. Covers the commands used by the driver, completes
+ * program and erase immediately and does not emulate HOLD#.
+ */
+
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(spi_flash_en25_emul, CONFIG_FLASH_LOG_LEVEL);
+
+#define DT_DRV_COMPAT mxicy_en25
+
+#define CMD_WRITE_STATUS     0x01
+#define CMD_PAGE_PROGRAM     0x02
+#define CMD_READ	     0x03
+#define CMD_READ_STATUS	     0x05
+#define CMD_WRITE_ENABLE     0x06
+#define CMD_SECTOR_ERASE     0x20
+#define CMD_HALF_BLOCK_ERASE 0x52
+#define CMD_CHIP_ERASE	     0xC7
+#define CMD_CHIP_ERASE_ALT   0x60
+#define CMD_RESET_ENABLE     0x66
+#define CMD_ENTER_UDPD	     0x79
+#define CMD_RESET	     0x99
+#define CMD_READ_ID	     0x9F
+#define CMD_EXIT_DPD	     0xAB
+#define CMD_ENTER_DPD	     0xB9
+#define CMD_FULL_BLOCK_ERASE 0xD8
+
+#define STATUS_REG_WRITE_ENABLE_LATCH 0x02
+
+#define ADDR_LEN 3
+
+struct spi_flash_en25_emul_config {
+	uint8_t *mem;
+	size_t size;
+	uint32_t page_size;
+	uint32_t erase_sector_size;
+	uint32_t erase_half_block_size;
+	uint32_t erase_full_block_size;
+	uint8_t jedec_id[3];
+};
+
+struct spi_flash_en25_emul_data {
+	uint8_t status;
+	bool dpd;
+};
+
+/* Byte @p idx of a buffer set, 0 past its end or for buffers without data */
+static uint8_t buf_set_get(const struct spi_buf_set *set, size_t idx)
+{
+	for (size_t i = 0; set && i < set->count; i++) {
+		if (idx < set->buffers[i].len) {
+			return set->buffers[i].buf ? ((uint8_t *)set->buffers[i].buf)[idx] : 0;
+		}
+		idx -= set->buffers[i].len;
+	}
+
+	return 0;
+}
+
+static void buf_set_put(const struct spi_buf_set *set, size_t idx, uint8_t val)
+{
+	for (size_t i = 0; set && i < set->count; i++) {
+		if (idx < set->buffers[i].len) {
+			if (set->buffers[i].buf) {
+				((uint8_t *)set->buffers[i].buf)[idx] = val;
+			}
+			return;
+		}
+		idx -= set->buffers[i].len;
+	}
+}
+
+static size_t buf_set_len(const struct spi_buf_set *set)
+{
+	size_t len = 0;
+
+	for (size_t i = 0; set && i < set->count; i++) {
+		len += set->buffers[i].len;
+	}
+
+	return len;
+}
+
+static uint32_t get_addr(const struct spi_buf_set *tx)
+{
+	return (buf_set_get(tx, 1) << 16) | (buf_set_get(tx, 2) << 8) | buf_set_get(tx, 3);
+}
+
+static void erase(const struct spi_flash_en25_emul_config *cfg, uint32_t addr, uint32_t size)
+{
+	addr = (addr % cfg->size) & ~(size - 1);
+	memset(&cfg->mem[addr], 0xFF, MIN(size, cfg->size - addr));
+}
+
+static int spi_flash_en25_emul_io(const struct emul *target, const struct spi_config *config,
+				  const struct spi_buf_set *tx, const struct spi_buf_set *rx)
+{
+	const struct spi_flash_en25_emul_config *cfg = target->cfg;
+	struct spi_flash_en25_emul_data *data = target->data;
+	size_t len = MAX(buf_set_len(tx), buf_set_len(rx));
+	uint8_t cmd = buf_set_get(tx, 0);
+	bool write_enabled = data->status & STATUS_REG_WRITE_ENABLE_LATCH;
+	uint32_t addr;
+
+	if (len == 0) {
+		return 0;
+	}
+
+	/* Only the resume command is recognized in deep power-down */
+	if (data->dpd && cmd != CMD_EXIT_DPD) {
+		return 0;
+	}
+
+	switch (cmd) {
+	case CMD_READ_ID:
+		for (size_t i = 1; i < len; i++) {
+			buf_set_put(rx, i, i <= sizeof(cfg->jedec_id) ? cfg->jedec_id[i - 1] : 0);
+		}
+		break;
+	case CMD_READ_STATUS:
+		for (size_t i = 1; i < len; i++) {
+			buf_set_put(rx, i, data->status);
+		}
+		break;
+	case CMD_WRITE_ENABLE:
+		data->status |= STATUS_REG_WRITE_ENABLE_LATCH;
+		break;
+	case CMD_WRITE_STATUS:
+		data->status &= ~STATUS_REG_WRITE_ENABLE_LATCH;
+		break;
+	case CMD_READ:
+		addr = get_addr(tx);
+		for (size_t i = 1 + ADDR_LEN; i < len; i++) {
+			buf_set_put(rx, i, cfg->mem[addr++ % cfg->size]);
+		}
+		break;
+	case CMD_PAGE_PROGRAM:
+		if (!write_enabled) {
+			break;
+		}
+		addr = get_addr(tx) % cfg->size;
+		for (size_t i = 1 + ADDR_LEN; i < len; i++) {
+			/* Programming wraps around within the page and can only clear bits */
+			uint32_t page = addr & ~(cfg->page_size - 1);
+			uint32_t col = (addr + i - 1 - ADDR_LEN) % cfg->page_size;
+
+			cfg->mem[page + col] &= buf_set_get(tx, i);
+		}
+		data->status &= ~STATUS_REG_WRITE_ENABLE_LATCH;
+		break;
+	case CMD_SECTOR_ERASE:
+	case CMD_HALF_BLOCK_ERASE:
+	case CMD_FULL_BLOCK_ERASE:
+		if (!write_enabled) {
+			break;
+		}
+		erase(cfg, get_addr(tx),
+		      cmd == CMD_SECTOR_ERASE	     ? cfg->erase_sector_size
+		      : cmd == CMD_HALF_BLOCK_ERASE ? cfg->erase_half_block_size
+						    : cfg->erase_full_block_size);
+		data->status &= ~STATUS_REG_WRITE_ENABLE_LATCH;
+		break;
+	case CMD_CHIP_ERASE:
+	case CMD_CHIP_ERASE_ALT:
+		if (!write_enabled) {
+			break;
+		}
+		memset(cfg->mem, 0xFF, cfg->size);
+		data->status &= ~STATUS_REG_WRITE_ENABLE_LATCH;
+		break;
+	case CMD_ENTER_DPD:
+	case CMD_ENTER_UDPD:
+		data->dpd = true;
+		break;
+	case CMD_EXIT_DPD:
+		data->dpd = false;
+		break;
+	case CMD_RESET_ENABLE:
+	case CMD_RESET:
+		data->status = 0;
+		break;
+	default:
+		LOG_WRN("Unsupported command 0x%02x", cmd);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static const struct spi_emul_api spi_flash_en25_emul_api = {
+	.io = spi_flash_en25_emul_io,
+};
+
+static int spi_flash_en25_emul_init(const struct emul *target, const struct device *parent)
+{
+	const struct spi_flash_en25_emul_config *cfg = target->cfg;
+
+	memset(cfg->mem, 0xFF, cfg->size);
+
+	return 0;
+}
+
+#define SPI_FLASH_EN25_EMUL(idx)                                                                   \
+	static uint8_t inst_##idx##_emul_mem[DT_INST_PROP(idx, size) / 8];                         \
+	static const struct spi_flash_en25_emul_config inst_##idx##_emul_config = {                \
+		.mem = inst_##idx##_emul_mem,                                                      \
+		.size = sizeof(inst_##idx##_emul_mem),                                             \
+		.page_size = DT_INST_PROP(idx, write_sector_size),                                 \
+		.erase_sector_size = DT_INST_PROP(idx, erase_sector_size),                         \
+		.erase_half_block_size = DT_INST_PROP(idx, erase_half_block_size),                 \
+		.erase_full_block_size = DT_INST_PROP(idx, erase_full_block_size),                 \
+		.jedec_id = DT_INST_PROP(idx, jedec_id),                                           \
+	};                                                                                         \
+	static struct spi_flash_en25_emul_data inst_##idx##_emul_data;                             \
+	EMUL_DT_INST_DEFINE(idx, spi_flash_en25_emul_init, &inst_##idx##_emul_data,                \
+			    &inst_##idx##_emul_config, &spi_flash_en25_emul_api, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(SPI_FLASH_EN25_EMUL)
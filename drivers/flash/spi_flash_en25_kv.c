@@ -0,0 +1,599 @@
+/*
+ * COPYRIGHT NOTICE: (c) 2023 Irnas.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Log structured key-value store. The region is a ring of erase sectors, each starting with a
+ * write sector that holds its sequence number. Records start on write sector boundaries and never
+ * cross an erase sector. A record is a header with the key, value length and a CRC32, followed by
+ * the value. Deleting a key appends a record without a value.
+ *
+ * The sector after the one being written is always kept erased. Moving to it copies the live
+ * records of the oldest sector, the one after it, to the new sector and erases the oldest one.
+ *
+ * A RAM hash table maps keys to the offset and length of their latest value, so a lookup is a
+ * single flash read.
+ */
+
+#include "spi_flash_en25.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+LOG_MODULE_REGISTER(spi_flash_en25_kv, CONFIG_FLASH_LOG_LEVEL);
+
+#define KV_SECTOR_MAGIC 0x4B565331
+#define KV_ERASED	UINT32_MAX
+
+#define KV_TYPE_VALUE	0xA5
+#define KV_TYPE_DELETED 0x5A
+
+struct kv_sector_header {
+	uint32_t magic;
+	uint32_t seq;
+} __packed;
+
+struct kv_record_header {
+	uint32_t key;
+	uint16_t len;
+	uint8_t type;
+	uint8_t reserved;
+	/* CRC32 of the fields above and the value */
+	uint32_t crc;
+} __packed;
+
+static size_t sector_count(const struct spi_flash_en25_kv_store *store)
+{
+	return store->size / store->sector_size;
+}
+
+static off_t sector_start(const struct spi_flash_en25_kv_store *store, size_t sector)
+{
+	return store->offset + (off_t)(sector * store->sector_size);
+}
+
+static off_t sector_end(const struct spi_flash_en25_kv_store *store, size_t sector)
+{
+	return sector_start(store, sector + 1);
+}
+
+static size_t next_sector(const struct spi_flash_en25_kv_store *store, size_t sector)
+{
+	return (sector + 1) % sector_count(store);
+}
+
+static size_t record_len(const struct spi_flash_en25_kv_store *store, size_t value_len)
+{
+	return ROUND_UP(sizeof(struct kv_record_header) + value_len, store->page_size);
+}
+
+static size_t max_value_len(const struct spi_flash_en25_kv_store *store)
+{
+	/* The first write sector holds the sector header */
+	return MIN(store->sector_size - store->page_size - sizeof(struct kv_record_header),
+		   UINT16_MAX);
+}
+
+static size_t home_slot(const struct spi_flash_en25_kv_store *store, uint32_t key)
+{
+	/* Fibonacci hashing spreads sequential keys */
+	return (key * 2654435761U) % store->index_size;
+}
+
+/* Returns the slot holding the key, or the empty slot where it would go */
+static struct spi_flash_en25_kv_entry *index_find(struct spi_flash_en25_kv_store *store,
+						  uint32_t key)
+{
+	size_t i = home_slot(store, key);
+
+	/* The table is larger than max_keys, so there is always an empty slot */
+	while (store->index[i].key != key && store->index[i].key != KV_ERASED) {
+		i = (i + 1) % store->index_size;
+	}
+
+	return &store->index[i];
+}
+
+static int index_put(struct spi_flash_en25_kv_store *store, uint32_t key, off_t offset,
+		     size_t len)
+{
+	struct spi_flash_en25_kv_entry *entry = index_find(store, key);
+
+	if (entry->key == KV_ERASED) {
+		if (store->count == store->max_keys) {
+			return -ENOMEM;
+		}
+		store->count++;
+	}
+
+	entry->key = key;
+	entry->offset = offset;
+	entry->len = len;
+
+	return 0;
+}
+
+static void index_remove(struct spi_flash_en25_kv_store *store, uint32_t key)
+{
+	size_t hole = index_find(store, key) - store->index;
+
+	if (store->index[hole].key == KV_ERASED) {
+		return;
+	}
+
+	/* Moves back entries that probed past the hole, so no lookup stops on it */
+	for (size_t i = (hole + 1) % store->index_size; store->index[i].key != KV_ERASED;
+	     i = (i + 1) % store->index_size) {
+		size_t home = home_slot(store, store->index[i].key);
+		/* Movable unless its home lies cyclically between the hole and itself */
+		bool movable = (hole <= i) ? (home <= hole || home > i)
+					   : (home <= hole && home > i);
+
+		if (movable) {
+			store->index[hole] = store->index[i];
+			hole = i;
+		}
+	}
+
+	store->index[hole].key = KV_ERASED;
+	store->count--;
+}
+
+static uint32_t header_crc(const struct kv_record_header *hdr)
+{
+	return crc32_ieee((const uint8_t *)hdr, offsetof(struct kv_record_header, crc));
+}
+
+static int read_sector_header(struct spi_flash_en25_kv_store *store, size_t sector,
+			      struct kv_sector_header *hdr)
+{
+	return flash_read(store->dev, sector_start(store, sector), hdr, sizeof(*hdr));
+}
+
+static int sector_erased(struct spi_flash_en25_kv_store *store, size_t sector, bool *erased)
+{
+	*erased = true;
+
+	for (off_t pos = sector_start(store, sector); *erased && pos < sector_end(store, sector);
+	     pos += store->page_size) {
+		int err = flash_read(store->dev, pos, store->page, store->page_size);
+
+		if (err) {
+			return err;
+		}
+
+		for (size_t i = 0; *erased && i < store->page_size; i++) {
+			*erased = store->page[i] == 0xFF;
+		}
+	}
+
+	return 0;
+}
+
+/* Makes the sector the one being written, it must be erased */
+static int open_sector(struct spi_flash_en25_kv_store *store, size_t sector)
+{
+	const struct kv_sector_header hdr = {
+		.magic = KV_SECTOR_MAGIC,
+		.seq = store->seq + 1,
+	};
+	int err;
+
+	err = flash_write(store->dev, sector_start(store, sector), &hdr, sizeof(hdr));
+	/* Not reused even if the write failed, the page may be partly programmed */
+	store->seq++;
+	store->head = sector;
+	store->next = sector_start(store, sector) + (off_t)store->page_size;
+
+	return err;
+}
+
+/* Copies a record to the end of the head sector, a page at a time */
+static int copy_record(struct spi_flash_en25_kv_store *store, struct spi_flash_en25_kv_entry *entry)
+{
+	size_t len = record_len(store, entry->len);
+	off_t dst = store->next;
+	int err = 0;
+
+	for (size_t done = 0; !err && done < len; done += store->page_size) {
+		err = flash_read(store->dev, entry->offset + done, store->page, store->page_size);
+		if (!err) {
+			err = flash_write(store->dev, dst + done, store->page, store->page_size);
+		}
+	}
+
+	store->next += len;
+	if (!err) {
+		entry->offset = dst;
+	}
+
+	return err;
+}
+
+/*
+ * Copies the live records of the oldest sector to the head sector and erases it. Deleted records
+ * are dropped, since no older value of their key is left anywhere.
+ */
+static int compact_sector(struct spi_flash_en25_kv_store *store, size_t sector)
+{
+	struct kv_sector_header hdr;
+	int err;
+
+	err = read_sector_header(store, sector, &hdr);
+	if (err || hdr.magic == KV_ERASED) {
+		return err;
+	}
+
+	for (size_t i = 0; i < store->index_size; i++) {
+		struct spi_flash_en25_kv_entry *entry = &store->index[i];
+
+		if (entry->key != KV_ERASED && entry->offset >= sector_start(store, sector) &&
+		    entry->offset < sector_end(store, sector)) {
+			err = copy_record(store, entry);
+			if (err) {
+				return err;
+			}
+		}
+	}
+
+	return flash_erase(store->dev, sector_start(store, sector), store->sector_size);
+}
+
+/* Makes room for a record in the head sector, moving to the next sector when it is full */
+static int reserve(struct spi_flash_en25_kv_store *store, size_t len)
+{
+	int err;
+
+	for (size_t moves = 0; store->next + (off_t)len > sector_end(store, store->head); moves++) {
+		/* Went around the ring and every sector is full of live records */
+		if (moves == sector_count(store)) {
+			return -ENOSPC;
+		}
+
+		err = open_sector(store, next_sector(store, store->head));
+		if (!err) {
+			err = compact_sector(store, next_sector(store, store->head));
+		}
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static int append(struct spi_flash_en25_kv_store *store, uint32_t key, uint8_t type,
+		  const void *value, size_t len, off_t *offset)
+{
+	struct kv_record_header hdr = {
+		.key = key,
+		.len = len,
+		.type = type,
+		.reserved = 0xFF,
+	};
+	size_t head_len = MIN(len, store->page_size - sizeof(hdr));
+	int err;
+
+	err = reserve(store, record_len(store, len));
+	if (err) {
+		return err;
+	}
+
+	hdr.crc = crc32_ieee_update(header_crc(&hdr), value, len);
+
+	/* The first page holds the header and the start of the value, the rest is written as is */
+	memcpy(store->page, &hdr, sizeof(hdr));
+	if (head_len) {
+		memcpy(&store->page[sizeof(hdr)], value, head_len);
+	}
+
+	*offset = store->next;
+	err = flash_write(store->dev, *offset, store->page, sizeof(hdr) + head_len);
+	if (!err && len > head_len) {
+		err = flash_write(store->dev, *offset + store->page_size,
+				  (const uint8_t *)value + head_len, len - head_len);
+	}
+
+	/* A failed record is skipped, its pages may be partly programmed */
+	store->next += record_len(store, len);
+
+	if (err) {
+		LOG_ERR("Writing key 0x%x failed: %d", key, err);
+	}
+
+	return err;
+}
+
+int spi_flash_en25_kv_write(struct spi_flash_en25_kv_store *store, uint32_t key, const void *data,
+			    size_t len)
+{
+	off_t offset;
+	int err;
+
+	if (key == KV_ERASED || len > max_value_len(store)) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&store->lock, K_FOREVER);
+
+	if (index_find(store, key)->key == KV_ERASED && store->count == store->max_keys) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	err = append(store, key, KV_TYPE_VALUE, data, len, &offset);
+	if (!err) {
+		err = index_put(store, key, offset, len);
+	}
+
+out:
+	k_mutex_unlock(&store->lock);
+
+	return err;
+}
+
+int spi_flash_en25_kv_read(struct spi_flash_en25_kv_store *store, uint32_t key, void *buf,
+			   size_t buf_len)
+{
+	const struct spi_flash_en25_kv_entry *entry;
+	int err;
+
+	k_mutex_lock(&store->lock, K_FOREVER);
+
+	entry = index_find(store, key);
+	if (key == KV_ERASED || entry->key == KV_ERASED) {
+		err = -ENOENT;
+	} else if (buf_len < entry->len) {
+		err = -ENOMEM;
+	} else {
+		err = flash_read(store->dev, entry->offset + sizeof(struct kv_record_header), buf,
+				 entry->len);
+		if (!err) {
+			err = entry->len;
+		}
+	}
+
+	k_mutex_unlock(&store->lock);
+
+	return err;
+}
+
+int spi_flash_en25_kv_delete(struct spi_flash_en25_kv_store *store, uint32_t key)
+{
+	off_t offset;
+	int err;
+
+	k_mutex_lock(&store->lock, K_FOREVER);
+
+	if (key == KV_ERASED || index_find(store, key)->key == KV_ERASED) {
+		err = -ENOENT;
+		goto out;
+	}
+
+	err = append(store, key, KV_TYPE_DELETED, NULL, 0, &offset);
+	if (!err) {
+		index_remove(store, key);
+	}
+
+out:
+	k_mutex_unlock(&store->lock);
+
+	return err;
+}
+
+size_t spi_flash_en25_kv_count_get(struct spi_flash_en25_kv_store *store)
+{
+	size_t count;
+
+	k_mutex_lock(&store->lock, K_FOREVER);
+	count = store->count;
+	k_mutex_unlock(&store->lock);
+
+	return count;
+}
+
+/* Checks the CRC of a record, reading its value a page at a time */
+static int record_valid(struct spi_flash_en25_kv_store *store, const struct kv_record_header *hdr,
+			off_t pos, bool *valid)
+{
+	uint32_t crc = header_crc(hdr);
+	off_t value = pos + sizeof(*hdr);
+
+	for (size_t done = 0; done < hdr->len;) {
+		size_t n = MIN(hdr->len - done, store->page_size);
+		int err = flash_read(store->dev, value + done, store->page, n);
+
+		if (err) {
+			return err;
+		}
+
+		crc = crc32_ieee_update(crc, store->page, n);
+		done += n;
+	}
+
+	*valid = crc == hdr->crc;
+
+	return 0;
+}
+
+/* Moves past the pages of an interrupted write, to the first erased page */
+static int skip_programmed(struct spi_flash_en25_kv_store *store, off_t *pos, off_t end)
+{
+	int err;
+
+	for (*pos += store->page_size; *pos < end; *pos += store->page_size) {
+		bool erased = true;
+
+		err = flash_read(store->dev, *pos, store->page, store->page_size);
+		if (err) {
+			return err;
+		}
+
+		for (size_t i = 0; erased && i < store->page_size; i++) {
+			erased = store->page[i] == 0xFF;
+		}
+
+		if (erased) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/* Adds the records of a sector to the index and returns where its free space starts */
+static int scan_sector(struct spi_flash_en25_kv_store *store, size_t sector, off_t *next)
+{
+	off_t end = sector_end(store, sector);
+	off_t pos = sector_start(store, sector) + (off_t)store->page_size;
+	struct kv_record_header hdr;
+	bool valid;
+	int err = 0;
+
+	while (!err && pos < end) {
+		err = flash_read(store->dev, pos, &hdr, sizeof(hdr));
+		if (err || hdr.key == KV_ERASED) {
+			break;
+		}
+
+		if ((hdr.type != KV_TYPE_VALUE && hdr.type != KV_TYPE_DELETED) ||
+		    pos + (off_t)record_len(store, hdr.len) > end) {
+			LOG_WRN("Skipping incomplete record at 0x%lx", (long)pos);
+			err = skip_programmed(store, &pos, end);
+			continue;
+		}
+
+		err = record_valid(store, &hdr, pos, &valid);
+		if (err) {
+			break;
+		}
+
+		if (!valid) {
+			LOG_WRN("Skipping corrupted record at 0x%lx", (long)pos);
+		} else if (hdr.type == KV_TYPE_VALUE) {
+			err = index_put(store, hdr.key, pos, hdr.len);
+		} else {
+			index_remove(store, hdr.key);
+		}
+
+		pos += record_len(store, hdr.len);
+	}
+
+	*next = MIN(pos, end);
+
+	return err;
+}
+
+/* Erases sectors left over from before the region held a store */
+static int format(struct spi_flash_en25_kv_store *store)
+{
+	bool erased;
+	int err;
+
+	for (size_t sector = 0; sector < sector_count(store); sector++) {
+		err = sector_erased(store, sector, &erased);
+		if (!err && !erased) {
+			err = flash_erase(store->dev, sector_start(store, sector),
+					  store->sector_size);
+		}
+		if (err) {
+			return err;
+		}
+	}
+
+	store->seq = 0;
+
+	return open_sector(store, 0);
+}
+
+/* Finishes a compaction that was interrupted by a reset */
+static int recover(struct spi_flash_en25_kv_store *store)
+{
+	size_t sector = next_sector(store, store->head);
+	struct kv_sector_header hdr;
+	bool erased;
+	int err;
+
+	err = read_sector_header(store, sector, &hdr);
+	if (err) {
+		return err;
+	}
+
+	if (hdr.magic == KV_SECTOR_MAGIC) {
+		LOG_WRN("Finishing compaction of sector %u", (unsigned int)sector);
+		return compact_sector(store, sector);
+	}
+
+	/* The erase itself may have been interrupted */
+	err = sector_erased(store, sector, &erased);
+	if (!err && !erased) {
+		err = flash_erase(store->dev, sector_start(store, sector), store->sector_size);
+	}
+
+	return err;
+}
+
+int spi_flash_en25_kv_store_init(struct spi_flash_en25_kv_store *store)
+{
+	struct kv_sector_header hdr;
+	bool found = false;
+	int err = 0;
+
+	if ((store->offset % store->sector_size) != 0 || (store->size % store->sector_size) != 0 ||
+	    sector_count(store) < 2) {
+		return -EINVAL;
+	}
+
+	k_mutex_init(&store->lock);
+	k_mutex_lock(&store->lock, K_FOREVER);
+
+	store->count = 0;
+	for (size_t i = 0; i < store->index_size; i++) {
+		store->index[i].key = KV_ERASED;
+	}
+
+	/* Sectors are opened in ring order, so the newest one tells where the ring starts */
+	for (size_t sector = 0; !err && sector < sector_count(store); sector++) {
+		err = read_sector_header(store, sector, &hdr);
+		if (!err && hdr.magic == KV_SECTOR_MAGIC && (!found || hdr.seq > store->seq)) {
+			found = true;
+			store->seq = hdr.seq;
+			store->head = sector;
+		}
+	}
+
+	if (err) {
+		goto out;
+	}
+
+	if (!found) {
+		err = format(store);
+		goto out;
+	}
+
+	/* One pass from the oldest sector to the newest, later records override earlier ones */
+	for (size_t i = 1; !err && i <= sector_count(store); i++) {
+		size_t sector = (store->head + i) % sector_count(store);
+
+		err = read_sector_header(store, sector, &hdr);
+		if (!err && hdr.magic == KV_SECTOR_MAGIC) {
+			err = scan_sector(store, sector, &store->next);
+		}
+	}
+
+	if (!err) {
+		err = recover(store);
+	}
+
+out:
+	k_mutex_unlock(&store->lock);
+
+	return err;
+}
@@ -0,0 +1,100 @@
+/*
+ * COPYRIGHT NOTICE: (c) 2023 Irnas.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "spi_flash_en25.h"
+
+#include <zephyr/device.h>
+#include <zephyr/shell/shell.h>
+
+/* Sectors read from the driver at once */
+#define HEATMAP_CHUNK 16
+
+static const struct device *get_device(const struct shell *sh, const char *name)
+{
+	const struct device *dev = device_get_binding(name);
+
+	if (!dev) {
+		shell_error(sh, "Device %s not found", name);
+		return NULL;
+	}
+
+	if (!spi_flash_en25_is_en25(dev)) {
+		shell_error(sh, "Device %s is not an EN25 flash", name);
+		return NULL;
+	}
+
+	return dev;
+}
+
+static int cmd_heatmap(const struct shell *sh, size_t argc, char **argv)
+{
+	struct spi_flash_en25_heatmap_entry entries[HEATMAP_CHUNK];
+	struct spi_flash_en25_heatmap_summary summary;
+	const struct device *dev = get_device(sh, argv[1]);
+	int err;
+
+	if (!dev) {
+		return -ENODEV;
+	}
+
+	spi_flash_en25_heatmap_summary_get(dev, &summary);
+
+	shell_print(sh, "requested %llu B, programmed %llu B, write amplification %u.%03u",
+		    (unsigned long long)summary.bytes_requested,
+		    (unsigned long long)summary.bytes_programmed,
+		    summary.write_amplification_milli / 1000,
+		    summary.write_amplification_milli % 1000);
+	shell_print(sh, "%llu erases, hottest sector %u with %u, %u sectors saturated",
+		    (unsigned long long)summary.total_erases, summary.hottest_sector,
+		    summary.max_erases, summary.saturated);
+	shell_print(sh, "%8s %8s %10s %10s %10s", "sector", "offset", "erases", "programs",
+		    "bytes");
+
+	/* Only sectors that were touched are listed */
+	for (uint32_t first = 0; first < summary.sectors; first += HEATMAP_CHUNK) {
+		size_t count = MIN(HEATMAP_CHUNK, summary.sectors - first);
+
+		err = spi_flash_en25_heatmap_get(dev, first, entries, count);
+		if (err) {
+			shell_error(sh, "Reading counters failed: %d", err);
+			return err;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			if (!entries[i].erases && !entries[i].programs) {
+				continue;
+			}
+			shell_print(sh, "%8u %8x %10u %10u %10u", first + (uint32_t)i,
+				    (first + (uint32_t)i) * summary.sector_size,
+				    entries[i].erases, entries[i].programs, entries[i].bytes);
+		}
+	}
+
+	return 0;
+}
+
+static int cmd_heatmap_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = get_device(sh, argv[1]);
+
+	if (!dev) {
+		return -ENODEV;
+	}
+
+	spi_flash_en25_heatmap_reset(dev);
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_en25,
+			       SHELL_CMD_ARG(heatmap, NULL,
+					     "Show erase and program counters <device>",
+					     cmd_heatmap, 2, 0),
+			       SHELL_CMD_ARG(heatmap_reset, NULL, "Clear the counters <device>",
+					     cmd_heatmap_reset, 2, 0),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(en25, &sub_en25, "EN25 flash commands", NULL);
@@ -0,0 +1,100 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/mem_manage.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define PAGE_SIZE CONFIG_MMU_PAGE_SIZE
+
+/* Page frames left unpinned, and pages mapped by the test. The arena fits the 48 slots. */
+#define FREE_PAGES  8
+#define ARENA_PAGES 32
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25));
+
+static uint8_t *arena;
+
+static uint8_t pattern(size_t page, size_t idx) { return (page * 31 + idx) & 0xFF; }
+
+static void *backing_store_suite_setup(void)
+{
+	size_t free_size;
+
+	zassert_true(device_is_ready(flash_dev), "Flash not ready");
+
+	/* Pin all but a few page frames, so the arena does not fit in RAM */
+	free_size = k_mem_free_get();
+	zassert_true(free_size > FREE_PAGES * PAGE_SIZE, "Not enough free memory");
+	zassert_not_null(k_mem_map(free_size - FREE_PAGES * PAGE_SIZE,
+				   K_MEM_PERM_RW | K_MEM_MAP_LOCK),
+			 "Pinning memory failed");
+
+	arena = k_mem_map(ARENA_PAGES * PAGE_SIZE, K_MEM_PERM_RW);
+	zassert_not_null(arena, "Mapping the arena failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(backing_store_suite, NULL, backing_store_suite_setup, NULL, NULL, NULL);
+
+ZTEST(backing_store_suite, test_page_out_and_in)
+{
+	struct spi_flash_en25_backing_store_stats stats;
+
+	for (size_t page = 0; page < ARENA_PAGES; page++) {
+		for (size_t i = 0; i < PAGE_SIZE; i++) {
+			arena[page * PAGE_SIZE + i] = pattern(page, i);
+		}
+	}
+
+	/* Twice, so pages come back from the flash and from the staged batch */
+	for (int pass = 0; pass < 2; pass++) {
+		for (size_t page = 0; page < ARENA_PAGES; page++) {
+			for (size_t i = 0; i < PAGE_SIZE; i++) {
+				zassert_equal(arena[page * PAGE_SIZE + i], pattern(page, i),
+					      "Page %zu corrupted at %zu", page, i);
+			}
+		}
+	}
+
+	spi_flash_en25_backing_store_stats_get(&stats);
+
+	zassert_true(stats.page_outs >= ARENA_PAGES - FREE_PAGES, "Pages not paged out");
+	zassert_true(stats.page_ins > 0, "Pages not paged in");
+	zassert_true(stats.flushes > 0, "Batch never written");
+	zassert_true(stats.slots_used <= stats.slots, "Slot accounting broken");
+}
+
+ZTEST(backing_store_suite, test_fault_service_time)
+{
+	struct spi_flash_en25_backing_store_stats before, after;
+	uint32_t fault_max_us = 0;
+	uint64_t fault_total_us = 0;
+	uint32_t faults;
+
+	spi_flash_en25_backing_store_stats_get(&before);
+
+	/* One access per page. Only FREE_PAGES pages are resident, so most of them fault. */
+	for (size_t page = 0; page < ARENA_PAGES; page++) {
+		uint32_t start = k_cycle_get_32();
+		volatile uint8_t value = arena[page * PAGE_SIZE];
+		uint32_t elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+		(void)value;
+		fault_total_us += elapsed_us;
+		fault_max_us = MAX(fault_max_us, elapsed_us);
+	}
+
+	spi_flash_en25_backing_store_stats_get(&after);
+
+	faults = after.page_ins - before.page_ins;
+	zassert_true(faults > 0, "No page faults");
+
+	TC_PRINT("%u page faults, %llu us per access on average, %u us at most\n", faults,
+		 (unsigned long long)(fault_total_us / ARENA_PAGES), fault_max_us);
+	TC_PRINT("page-in: %llu us on average, %u us at most, %u served from the batch\n",
+		 (unsigned long long)((after.page_in_total_us - before.page_in_total_us) / faults),
+		 after.page_in_max_us,
+		 after.batch_hits - before.batch_hits);
+}
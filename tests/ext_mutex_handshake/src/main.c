@@ -0,0 +1,177 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define MASTER_NODE DT_NODELABEL(flash_master)
+#define SLAVE_NODE  DT_NODELABEL(flash_slave)
+
+#define ERASE_SECTOR_SIZE DT_PROP(MASTER_NODE, erase_sector_size)
+#define TEST_DATA_LEN	  DT_PROP(MASTER_NODE, write_sector_size)
+
+#define CYCLES	       20
+#define STACK_SIZE     2048
+#define THREAD_PRIO    5
+/* Well below CONFIG_SPI_FLASH_EN25_EXTERNAL_MUTEX_TIMEOUT */
+#define MAX_WAIT_US    (100 * USEC_PER_MSEC)
+
+static const struct device *master_dev = DEVICE_DT_GET(MASTER_NODE);
+static const struct device *slave_dev = DEVICE_DT_GET(SLAVE_NODE);
+
+static const struct gpio_dt_spec master_request =
+	GPIO_DT_SPEC_GET(MASTER_NODE, ext_mutex_request_gpios);
+static const struct gpio_dt_spec master_grant =
+	GPIO_DT_SPEC_GET(MASTER_NODE, ext_mutex_grant_gpios);
+static const struct gpio_dt_spec slave_request =
+	GPIO_DT_SPEC_GET(SLAVE_NODE, ext_mutex_request_gpios);
+static const struct gpio_dt_spec slave_grant =
+	GPIO_DT_SPEC_GET(SLAVE_NODE, ext_mutex_grant_gpios);
+
+K_THREAD_STACK_DEFINE(master_stack, STACK_SIZE);
+K_THREAD_STACK_DEFINE(slave_stack, STACK_SIZE);
+static struct k_thread master_thread;
+static struct k_thread slave_thread;
+
+static struct k_timer wire_timer;
+
+/* Plays the role of the wires between the two MCUs */
+static void wire_update(struct k_timer *timer)
+{
+	gpio_emul_input_set(slave_grant.port, slave_grant.pin,
+			    gpio_emul_output_get(master_grant.port, master_grant.pin));
+	gpio_emul_input_set(master_request.port, master_request.pin,
+			    gpio_emul_output_get(slave_request.port, slave_request.pin));
+}
+
+/* The wires have to work before the drivers bring up the chips */
+static int wire_init(void)
+{
+	k_timer_init(&wire_timer, wire_update, NULL);
+	k_timer_start(&wire_timer, K_TICKS(1), K_TICKS(1));
+
+	return 0;
+}
+
+SYS_INIT(wire_init, POST_KERNEL, 0);
+
+static void *handshake_suite_setup(void)
+{
+	zassert_true(device_is_ready(master_dev), "Master flash not ready");
+	zassert_true(device_is_ready(slave_dev), "Slave flash not ready");
+
+	return NULL;
+}
+
+static void handshake_before(void *fixture)
+{
+	struct spi_flash_en25_ext_mutex_stats stats;
+	uint8_t data;
+
+	/* Start each test with the master owning the flash */
+	zassert_ok(flash_read(master_dev, 0, &data, sizeof(data)));
+
+	(void)spi_flash_en25_ext_mutex_stats_get(master_dev, &stats, true);
+	(void)spi_flash_en25_ext_mutex_stats_get(slave_dev, &stats, true);
+}
+
+ZTEST_SUITE(ext_mutex_handshake_suite, NULL, handshake_suite_setup, handshake_before, NULL, NULL);
+
+static void write_read_cycles(const struct device *dev, off_t offset, uint8_t seed)
+{
+	static uint8_t buf[2][TEST_DATA_LEN];
+	uint8_t *data = buf[dev == slave_dev];
+	uint8_t readback[TEST_DATA_LEN];
+	int err;
+
+	for (int i = 0; i < CYCLES; i++) {
+		for (size_t j = 0; j < TEST_DATA_LEN; j++) {
+			data[j] = seed + i + j;
+		}
+
+		err = flash_erase(dev, offset, ERASE_SECTOR_SIZE);
+		zassert_equal(err, 0, "Flash erase failed");
+
+		err = flash_write(dev, offset, data, TEST_DATA_LEN);
+		zassert_equal(err, 0, "Flash write failed");
+
+		err = flash_read(dev, offset, readback, TEST_DATA_LEN);
+		zassert_equal(err, 0, "Flash read failed");
+		zassert_mem_equal(readback, data, TEST_DATA_LEN, "Read data does not match");
+	}
+}
+
+static void cycles_thread(void *p1, void *p2, void *p3)
+{
+	write_read_cycles(p1, (off_t)(uintptr_t)p2, (uint8_t)(uintptr_t)p3);
+}
+
+ZTEST(ext_mutex_handshake_suite, test_idle_master_hands_over)
+{
+	struct spi_flash_en25_ext_mutex_stats master_stats;
+	struct spi_flash_en25_ext_mutex_stats slave_stats;
+	uint8_t data = 0x5A;
+	int err;
+
+	/* The master owns the flash, the slave has to ask for it */
+	err = flash_read(slave_dev, 0, &data, sizeof(data));
+	zassert_equal(err, 0, "Slave read failed");
+
+	zassert_ok(spi_flash_en25_ext_mutex_stats_get(master_dev, &master_stats, false));
+	zassert_ok(spi_flash_en25_ext_mutex_stats_get(slave_dev, &slave_stats, false));
+
+	zassert_equal(slave_stats.waits, 1, "Slave did not wait for the grant");
+	zassert_equal(master_stats.handoffs, 1, "Master did not hand over");
+	zassert_equal(slave_stats.timeouts, 0, "Slave timed out");
+
+	/* The slave keeps the flash while the master does not need it */
+	err = flash_read(slave_dev, 0, &data, sizeof(data));
+	zassert_equal(err, 0, "Slave read failed");
+
+	zassert_ok(spi_flash_en25_ext_mutex_stats_get(slave_dev, &slave_stats, false));
+	zassert_equal(slave_stats.waits, 1, "Slave waited for a flash it owned");
+
+	/* And hands it back when the master asks */
+	err = flash_read(master_dev, 0, &data, sizeof(data));
+	zassert_equal(err, 0, "Master read failed");
+
+	zassert_ok(spi_flash_en25_ext_mutex_stats_get(master_dev, &master_stats, false));
+	zassert_ok(spi_flash_en25_ext_mutex_stats_get(slave_dev, &slave_stats, false));
+
+	zassert_equal(master_stats.waits, 1, "Master did not wait for the slave");
+	zassert_equal(slave_stats.handoffs, 1, "Slave did not hand over");
+}
+
+ZTEST(ext_mutex_handshake_suite, test_contention_alternates)
+{
+	struct spi_flash_en25_ext_mutex_stats master_stats;
+	struct spi_flash_en25_ext_mutex_stats slave_stats;
+
+	k_thread_create(&master_thread, master_stack, K_THREAD_STACK_SIZEOF(master_stack),
+			cycles_thread, (void *)master_dev, (void *)ERASE_SECTOR_SIZE,
+			(void *)0x10, THREAD_PRIO, 0, K_NO_WAIT);
+	k_thread_create(&slave_thread, slave_stack, K_THREAD_STACK_SIZEOF(slave_stack),
+			cycles_thread, (void *)slave_dev, (void *)(2 * ERASE_SECTOR_SIZE),
+			(void *)0x80, THREAD_PRIO, 0, K_NO_WAIT);
+
+	zassert_ok(k_thread_join(&master_thread, K_SECONDS(30)), "Master thread did not finish");
+	zassert_ok(k_thread_join(&slave_thread, K_SECONDS(30)), "Slave thread did not finish");
+
+	zassert_ok(spi_flash_en25_ext_mutex_stats_get(master_dev, &master_stats, false));
+	zassert_ok(spi_flash_en25_ext_mutex_stats_get(slave_dev, &slave_stats, false));
+
+	zassert_equal(master_stats.timeouts + slave_stats.timeouts, 0, "Requests timed out");
+
+	/* Neither side keeps the flash for a whole run of operations */
+	zassert_true(master_stats.handoffs > 1, "Master never handed over under contention");
+	zassert_true(slave_stats.handoffs > 1, "Slave never handed over under contention");
+
+	zassert_true(master_stats.wait_max_us < MAX_WAIT_US, "Master waited %u us",
+		     master_stats.wait_max_us);
+	zassert_true(slave_stats.wait_max_us < MAX_WAIT_US, "Slave waited %u us",
+		     slave_stats.wait_max_us);
+}
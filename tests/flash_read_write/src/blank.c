@@ -0,0 +1,88 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+#define WRITE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), write_sector_size)
+
+#define BLANK_REGION_OFFSET (ERASE_SECTOR_SIZE * 18)
+#define BLANK_REGION_SIZE   (ERASE_SECTOR_SIZE * 2)
+#define DIRTY_BYTE_OFFSET   (BLANK_REGION_OFFSET + 10)
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static void *blank_suite_setup(void)
+{
+	int err;
+
+	err = flash_erase(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_blank_suite, NULL, blank_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_blank_suite, test_blank_check)
+{
+	int err;
+	bool blank;
+	off_t found;
+	uint8_t zero = 0;
+
+	err = spi_flash_en25_is_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE, &blank);
+	zassert_equal(err, 0, "Blank check failed");
+	zassert_true(blank, "Erased region is not blank");
+
+	err = spi_flash_en25_find_non_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE,
+					    &found);
+	zassert_equal(err, -ENOENT, "Non-blank byte found in erased region");
+
+	err = flash_write(flash_dev, DIRTY_BYTE_OFFSET, &zero, 1);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = spi_flash_en25_is_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE, &blank);
+	zassert_equal(err, 0, "Blank check failed");
+	zassert_false(blank, "Written region reported as blank");
+
+	err = spi_flash_en25_find_non_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE,
+					    &found);
+	zassert_equal(err, 0, "Non-blank search failed");
+	zassert_equal(found, DIRTY_BYTE_OFFSET, "Wrong non-blank offset");
+
+	err = spi_flash_en25_find_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE,
+					WRITE_SECTOR_SIZE, &found);
+	zassert_equal(err, 0, "Blank search failed");
+	zassert_equal(found, BLANK_REGION_OFFSET + WRITE_SECTOR_SIZE, "Wrong blank offset");
+}
+
+ZTEST(flash_blank_suite, test_find_blank_sectors)
+{
+	int err;
+	off_t found;
+	uint8_t zero = 0;
+
+	err = flash_erase(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	/* Known to be erased, found without reading */
+	err = spi_flash_en25_find_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE,
+					BLANK_REGION_SIZE, &found);
+	zassert_equal(err, 0, "Blank search failed");
+	zassert_equal(found, BLANK_REGION_OFFSET, "Wrong blank offset");
+
+	err = flash_write(flash_dev, DIRTY_BYTE_OFFSET, &zero, 1);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = spi_flash_en25_find_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE,
+					BLANK_REGION_SIZE, &found);
+	zassert_equal(err, -ENOENT, "Written region reported as blank");
+
+	err = spi_flash_en25_find_blank(flash_dev, BLANK_REGION_OFFSET, BLANK_REGION_SIZE,
+					ERASE_SECTOR_SIZE, &found);
+	zassert_equal(err, 0, "Blank search failed");
+	zassert_equal(found, BLANK_REGION_OFFSET + ERASE_SECTOR_SIZE, "Wrong blank offset");
+}
@@ -0,0 +1,144 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define FLASH_NODE	  DT_NODELABEL(en25qh32b)
+#define ERASE_SECTOR_SIZE DT_PROP(FLASH_NODE, erase_sector_size)
+
+#define BLOB_FIRST_SECTOR 40
+#define BLOB_SECTORS	  8
+#define TELEMETRY_LEN	  4000
+
+#define BLOB_OFFSET (BLOB_FIRST_SECTOR * ERASE_SECTOR_SIZE)
+#define BLOB_SIZE   (BLOB_SECTORS * ERASE_SECTOR_SIZE)
+#define MAX_BLOBS   4
+
+SPI_FLASH_EN25_BLOB_STORE_DEFINE(store, FLASH_NODE, BLOB_OFFSET, BLOB_SIZE, MAX_BLOBS);
+/* Same region, never initialized */
+SPI_FLASH_EN25_BLOB_STORE_DEFINE(unscanned, FLASH_NODE, BLOB_OFFSET, BLOB_SIZE, MAX_BLOBS);
+
+static const struct device *flash_dev = DEVICE_DT_GET(FLASH_NODE);
+
+static uint8_t telemetry[TELEMETRY_LEN];
+static uint8_t noise[TELEMETRY_LEN / 4];
+static uint8_t read_data[TELEMETRY_LEN];
+
+static void *blob_suite_setup(void)
+{
+	uint32_t x = 1;
+
+	/* Records with slowly changing fields compress well */
+	for (size_t i = 0; i < TELEMETRY_LEN; i += 8) {
+		memcpy(&telemetry[i], "T:", 2);
+		telemetry[i + 2] = i / 512;
+		telemetry[i + 3] = (i / 64) & 0x0F;
+		memset(&telemetry[i + 4], 0, 4);
+	}
+
+	/* Pseudo random data does not */
+	for (size_t i = 0; i < sizeof(noise); i++) {
+		x = x * 1103515245 + 12345;
+		noise[i] = x >> 16;
+	}
+
+	return NULL;
+}
+
+static void blob_before(void *fixture)
+{
+	zassert_ok(spi_flash_en25_blob_clear(&store));
+}
+
+ZTEST_SUITE(flash_blob_suite, NULL, blob_suite_setup, blob_before, NULL, NULL);
+
+ZTEST(flash_blob_suite, test_blob_roundtrip)
+{
+	struct spi_flash_en25_blob_info info;
+	int len;
+
+	zassert_ok(spi_flash_en25_blob_write(&store, 1, telemetry, sizeof(telemetry)));
+	zassert_ok(spi_flash_en25_blob_write(&store, 2, noise, sizeof(noise)));
+
+	zassert_ok(spi_flash_en25_blob_info_get(&store, 1, &info));
+	zassert_equal(info.len, sizeof(telemetry), "Wrong length");
+	zassert_true(info.stored_len < sizeof(telemetry) / 2, "Telemetry not compressed");
+
+	len = spi_flash_en25_blob_read(&store, 1, read_data, sizeof(read_data));
+	zassert_equal(len, sizeof(telemetry), "Read failed: %d", len);
+	zassert_mem_equal(read_data, telemetry, sizeof(telemetry), "Telemetry corrupted");
+
+	/* Data that does not compress is stored as it is */
+	len = spi_flash_en25_blob_read(&store, 2, read_data, sizeof(read_data));
+	zassert_equal(len, sizeof(noise), "Read failed: %d", len);
+	zassert_mem_equal(read_data, noise, sizeof(noise), "Noise corrupted");
+
+	len = spi_flash_en25_blob_read(&store, 1, read_data, sizeof(telemetry) - 1);
+	zassert_equal(len, -ENOMEM, "Short buffer accepted");
+}
+
+ZTEST(flash_blob_suite, test_blob_write_before_init)
+{
+	struct spi_flash_en25_blob_info info;
+
+	zassert_ok(spi_flash_en25_blob_write(&store, 1, noise, sizeof(noise)));
+
+	zassert_equal(spi_flash_en25_blob_write(&unscanned, 2, noise, sizeof(noise)), -EACCES,
+		      "Write to a store that was not scanned accepted");
+	zassert_equal(spi_flash_en25_blob_free_get(&unscanned), BLOB_SIZE, "Wrong free space");
+
+	zassert_ok(spi_flash_en25_blob_store_init(&unscanned));
+	zassert_ok(spi_flash_en25_blob_info_get(&unscanned, 1, &info));
+}
+
+ZTEST(flash_blob_suite, test_blob_replace_delete_and_rescan)
+{
+	int len;
+
+	zassert_ok(spi_flash_en25_blob_write(&store, 1, noise, sizeof(noise)));
+	zassert_ok(spi_flash_en25_blob_write(&store, 1, telemetry, sizeof(telemetry)));
+	zassert_ok(spi_flash_en25_blob_write(&store, 2, noise, sizeof(noise)));
+	zassert_ok(spi_flash_en25_blob_delete(&store, 2));
+	zassert_equal(spi_flash_en25_blob_delete(&store, 2), -ENOENT, "Deleted twice");
+
+	/* The index is rebuilt from flash */
+	zassert_ok(spi_flash_en25_blob_store_init(&store));
+
+	len = spi_flash_en25_blob_read(&store, 1, read_data, sizeof(read_data));
+	zassert_equal(len, sizeof(telemetry), "Replaced blob not found: %d", len);
+	zassert_mem_equal(read_data, telemetry, sizeof(telemetry), "Wrong copy found");
+
+	len = spi_flash_en25_blob_read(&store, 2, read_data, sizeof(read_data));
+	zassert_equal(len, -ENOENT, "Deleted blob found");
+}
+
+ZTEST(flash_blob_suite, test_blob_interrupted_write)
+{
+	const uint8_t partial[] = {0x42, 0x4F, 0x4C, 0x42, 0x03, 0x00, 0x00, 0x00};
+	size_t free_before = spi_flash_en25_blob_free_get(&store);
+	int len;
+
+	/* Header of a blob whose write never finished */
+	zassert_ok(flash_write(flash_dev, BLOB_OFFSET, partial, sizeof(partial)));
+
+	zassert_ok(spi_flash_en25_blob_store_init(&store));
+	zassert_true(spi_flash_en25_blob_free_get(&store) < free_before, "Partial blob reused");
+
+	zassert_ok(spi_flash_en25_blob_write(&store, 3, telemetry, sizeof(telemetry)));
+	len = spi_flash_en25_blob_read(&store, 3, read_data, sizeof(read_data));
+	zassert_equal(len, sizeof(telemetry), "Read after skipped blob failed: %d", len);
+}
+
+ZTEST(flash_blob_suite, test_blob_full)
+{
+	int err = 0;
+
+	for (uint32_t id = 0; !err; id++) {
+		err = spi_flash_en25_blob_write(&store, id, noise, sizeof(noise));
+	}
+
+	/* The region has room for more blobs than the index */
+	zassert_equal(err, -ENOMEM, "Full index not reported");
+}
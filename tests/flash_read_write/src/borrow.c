@@ -0,0 +1,92 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define BORROW_REGION_OFFSET (ERASE_SECTOR_SIZE * 26)
+#define TEST_DATA_LEN	     64
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t test_data[TEST_DATA_LEN];
+
+static void *borrow_suite_setup(void)
+{
+	int err;
+
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		test_data[i] = i + 3;
+	}
+
+	err = flash_erase(flash_dev, BORROW_REGION_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	err = flash_write(flash_dev, BORROW_REGION_OFFSET, test_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash write failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_borrow_suite, NULL, borrow_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_borrow_suite, test_borrow_release)
+{
+	const void *data;
+	int err;
+
+	err = spi_flash_en25_read_borrow(flash_dev, BORROW_REGION_OFFSET, TEST_DATA_LEN, &data,
+					 K_NO_WAIT);
+	zassert_equal(err, 0, "Borrow failed");
+	zassert_mem_equal(data, test_data, TEST_DATA_LEN, "Borrowed data does not match");
+
+	err = spi_flash_en25_read_release(flash_dev, data);
+	zassert_equal(err, 0, "Release failed");
+
+	err = spi_flash_en25_read_release(flash_dev, data);
+	zassert_equal(err, -EINVAL, "Double release accepted");
+}
+
+ZTEST(flash_borrow_suite, test_borrow_exhausted)
+{
+	const void *data[CONFIG_SPI_FLASH_EN25_BORROW_SLOTS];
+	const void *extra;
+	int err;
+
+	for (size_t i = 0; i < ARRAY_SIZE(data); i++) {
+		err = spi_flash_en25_read_borrow(flash_dev, BORROW_REGION_OFFSET, 1, &data[i],
+						 K_NO_WAIT);
+		zassert_equal(err, 0, "Borrow failed");
+	}
+
+	err = spi_flash_en25_read_borrow(flash_dev, BORROW_REGION_OFFSET, 1, &extra, K_NO_WAIT);
+	zassert_equal(err, -ENOMEM, "Borrow succeeded without a free buffer");
+
+	for (size_t i = 0; i < ARRAY_SIZE(data); i++) {
+		err = spi_flash_en25_read_release(flash_dev, data[i]);
+		zassert_equal(err, 0, "Release failed");
+	}
+}
+
+/* Runs last, as it erases the test data */
+ZTEST(flash_borrow_suite, test_erase_while_borrowed)
+{
+	const void *data;
+	int err;
+
+	err = spi_flash_en25_read_borrow(flash_dev, BORROW_REGION_OFFSET, TEST_DATA_LEN, &data,
+					 K_NO_WAIT);
+	zassert_equal(err, 0, "Borrow failed");
+
+	err = flash_erase(flash_dev, BORROW_REGION_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	/* The buffer keeps the old contents until released */
+	zassert_mem_equal(data, test_data, TEST_DATA_LEN, "Borrowed buffer was modified");
+
+	err = spi_flash_en25_read_release(flash_dev, data);
+	zassert_equal(err, -ESTALE, "Erase of borrowed region not reported");
+}
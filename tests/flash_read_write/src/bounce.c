@@ -0,0 +1,60 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define BOUNCE_SECTOR 48
+#define BOUNCE_OFFSET (ERASE_SECTOR_SIZE * BOUNCE_SECTOR)
+/* Spans several write sectors and does not start on one */
+#define TEST_DATA_LEN 700
+#define TEST_SHIFT    13
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+/* Stays in internal flash */
+static const uint8_t const_data[TEST_DATA_LEN] = {
+	[0] = 0x11, [1] = 0x22, [255] = 0x33, [256] = 0x44, [TEST_DATA_LEN - 1] = 0x55,
+};
+
+static uint8_t test_data[TEST_DATA_LEN + 1] __aligned(4);
+static uint8_t read_data[TEST_DATA_LEN + 1] __aligned(4);
+
+static void *bounce_suite_setup(void)
+{
+	for (size_t i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = i ^ 0xA5;
+	}
+
+	return NULL;
+}
+
+static void bounce_before(void *fixture)
+{
+	zassert_ok(flash_erase(flash_dev, BOUNCE_OFFSET, ERASE_SECTOR_SIZE));
+}
+
+ZTEST_SUITE(flash_bounce_suite, NULL, bounce_suite_setup, bounce_before, NULL, NULL);
+
+ZTEST(flash_bounce_suite, test_write_const_data)
+{
+	zassert_ok(flash_write(flash_dev, BOUNCE_OFFSET + TEST_SHIFT, const_data,
+			       sizeof(const_data)));
+
+	zassert_ok(
+		flash_read(flash_dev, BOUNCE_OFFSET + TEST_SHIFT, read_data, sizeof(const_data)));
+	zassert_mem_equal(read_data, const_data, sizeof(const_data), "Const data corrupted");
+}
+
+ZTEST(flash_bounce_suite, test_unaligned_buffers)
+{
+	/* Off by one byte from the alignment set in prj.conf */
+	zassert_ok(
+		flash_write(flash_dev, BOUNCE_OFFSET + TEST_SHIFT, &test_data[1], TEST_DATA_LEN));
+
+	memset(read_data, 0, sizeof(read_data));
+	zassert_ok(flash_read(flash_dev, BOUNCE_OFFSET + TEST_SHIFT, &read_data[1], TEST_DATA_LEN));
+	zassert_mem_equal(&read_data[1], &test_data[1], TEST_DATA_LEN, "Unaligned data corrupted");
+	zassert_equal(read_data[0], 0, "Read past the start of the buffer");
+}
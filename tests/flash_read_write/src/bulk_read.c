@@ -0,0 +1,193 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define BULK_OFFSET (ERASE_SECTOR_SIZE * 64)
+/* Several chunks with a partial one at the end */
+#define BULK_LEN    (CONFIG_SPI_FLASH_EN25_BULK_READ_CHUNK_SIZE * 5 + 100)
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t test_data[BULK_LEN];
+static uint8_t read_data[BULK_LEN];
+
+struct bulk_chunk {
+	off_t offset;
+	const uint8_t *data;
+	size_t len;
+};
+
+K_MSGQ_DEFINE(chunk_q, sizeof(struct bulk_chunk), CONFIG_SPI_FLASH_EN25_BULK_READ_BUFS, 4);
+
+static K_THREAD_STACK_DEFINE(consumer_stack, 1024);
+static struct k_thread consumer_thread;
+static atomic_t held;
+static atomic_t max_held;
+static size_t consumed;
+static bool out_of_order;
+
+static void *bulk_suite_setup(void)
+{
+	for (size_t i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = (i * 7) ^ (i >> 8);
+	}
+
+	zassert_ok(flash_erase(flash_dev, BULK_OFFSET, ROUND_UP(BULK_LEN, ERASE_SECTOR_SIZE)));
+	zassert_ok(flash_write(flash_dev, BULK_OFFSET, test_data, sizeof(test_data)));
+
+	return NULL;
+}
+
+static void bulk_before(void *fixture)
+{
+	memset(read_data, 0, sizeof(read_data));
+	atomic_clear(&held);
+	atomic_clear(&max_held);
+	consumed = 0;
+	out_of_order = false;
+	k_msgq_purge(&chunk_q);
+}
+
+ZTEST_SUITE(flash_bulk_read_suite, NULL, bulk_suite_setup, bulk_before, NULL, NULL);
+
+/* Also runs in the consumer thread, so it records errors instead of asserting */
+static void store_chunk(off_t offset, const uint8_t *chunk, size_t len)
+{
+	if (offset != BULK_OFFSET + consumed || consumed + len > BULK_LEN) {
+		out_of_order = true;
+		return;
+	}
+
+	memcpy(&read_data[consumed], chunk, len);
+	consumed += len;
+}
+
+static int release_in_cb(const struct device *dev, off_t offset, const uint8_t *chunk, size_t len,
+			 void *user_data)
+{
+	store_chunk(offset, chunk, len);
+
+	return spi_flash_en25_bulk_read_release(dev, chunk);
+}
+
+ZTEST(flash_bulk_read_suite, test_bulk_read_sync_consumer)
+{
+	zassert_ok(spi_flash_en25_bulk_read(flash_dev, BULK_OFFSET, BULK_LEN, release_in_cb, NULL,
+					    K_NO_WAIT));
+	zassert_false(out_of_order, "Chunk out of order");
+	zassert_equal(consumed, BULK_LEN, "Only %zu bytes consumed", consumed);
+	zassert_mem_equal(read_data, test_data, BULK_LEN, "Bulk read data does not match");
+}
+
+static int queue_chunk(const struct device *dev, off_t offset, const uint8_t *chunk, size_t len,
+		       void *user_data)
+{
+	struct bulk_chunk c = {.offset = offset, .data = chunk, .len = len};
+	atomic_val_t now = atomic_inc(&held) + 1;
+
+	if (now > atomic_get(&max_held)) {
+		atomic_set(&max_held, now);
+	}
+
+	return k_msgq_put(&chunk_q, &c, K_NO_WAIT);
+}
+
+static void consumer_entry(void *p1, void *p2, void *p3)
+{
+	struct bulk_chunk c;
+
+	while (consumed < BULK_LEN && k_msgq_get(&chunk_q, &c, K_SECONDS(5)) == 0) {
+		/* A consumer slower than the flash */
+		k_msleep(10);
+		store_chunk(c.offset, c.data, c.len);
+		atomic_dec(&held);
+		(void)spi_flash_en25_bulk_read_release(flash_dev, c.data);
+	}
+}
+
+ZTEST(flash_bulk_read_suite, test_bulk_read_slow_consumer)
+{
+	k_thread_create(&consumer_thread, consumer_stack, K_THREAD_STACK_SIZEOF(consumer_stack),
+			consumer_entry, NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+
+	zassert_ok(spi_flash_en25_bulk_read(flash_dev, BULK_OFFSET, BULK_LEN, queue_chunk, NULL,
+					    K_SECONDS(1)));
+
+	zassert_ok(k_thread_join(&consumer_thread, K_SECONDS(5)));
+	zassert_false(out_of_order, "Chunk out of order");
+	zassert_equal(consumed, BULK_LEN, "Only %zu bytes consumed", consumed);
+	zassert_mem_equal(read_data, test_data, BULK_LEN, "Bulk read data does not match");
+	zassert_true(atomic_get(&max_held) <= CONFIG_SPI_FLASH_EN25_BULK_READ_BUFS,
+		     "Consumer held %ld buffers", (long)atomic_get(&max_held));
+}
+
+ZTEST(flash_bulk_read_suite, test_bulk_read_stalled_consumer)
+{
+	struct bulk_chunk c;
+	int err;
+
+	/* Nobody releases the chunks */
+	err = spi_flash_en25_bulk_read(flash_dev, BULK_OFFSET, BULK_LEN, queue_chunk, NULL,
+				       K_MSEC(50));
+	zassert_equal(err, -EAGAIN, "Stalled consumer not detected: %d", err);
+
+	while (k_msgq_get(&chunk_q, &c, K_NO_WAIT) == 0) {
+		zassert_ok(spi_flash_en25_bulk_read_release(flash_dev, c.data));
+	}
+
+	zassert_equal(spi_flash_en25_bulk_read_release(flash_dev, c.data), -EINVAL,
+		      "Double release accepted");
+
+	/* All buffers are back */
+	zassert_ok(spi_flash_en25_bulk_read(flash_dev, BULK_OFFSET, BULK_LEN, release_in_cb, NULL,
+					    K_NO_WAIT));
+	zassert_mem_equal(read_data, test_data, BULK_LEN, "Bulk read data does not match");
+}
+
+ZTEST(flash_bulk_read_suite, test_bulk_read_unbounded_wait)
+{
+	int err = spi_flash_en25_bulk_read(flash_dev, BULK_OFFSET, BULK_LEN, release_in_cb, NULL,
+					   K_FOREVER);
+
+	zassert_equal(err, -EINVAL, "Unbounded wait accepted: %d", err);
+	zassert_equal(consumed, 0, "Read started");
+}
+
+static int stop_after_first(const struct device *dev, off_t offset, const uint8_t *chunk,
+			    size_t len, void *user_data)
+{
+	int *calls = user_data;
+
+	(*calls)++;
+	store_chunk(offset, chunk, len);
+	(void)spi_flash_en25_bulk_read_release(dev, chunk);
+
+	return 1;
+}
+
+ZTEST(flash_bulk_read_suite, test_bulk_read_stop)
+{
+	struct bulk_chunk c;
+	int calls = 0;
+
+	zassert_ok(spi_flash_en25_bulk_read(flash_dev, BULK_OFFSET, BULK_LEN, stop_after_first,
+					    &calls, K_NO_WAIT));
+	zassert_equal(calls, 1, "Read continued after stop");
+	zassert_equal(consumed, CONFIG_SPI_FLASH_EN25_BULK_READ_CHUNK_SIZE, "Wrong chunk size");
+
+	/* The buffer read ahead was returned as well, so all but one can be handed out again */
+	zassert_equal(spi_flash_en25_bulk_read(flash_dev, BULK_OFFSET, BULK_LEN, queue_chunk, NULL,
+					       K_NO_WAIT),
+		      -EAGAIN, "Consumer did not stall");
+	zassert_true(k_msgq_num_used_get(&chunk_q) >= CONFIG_SPI_FLASH_EN25_BULK_READ_BUFS - 1,
+		     "Bulk read buffer leaked");
+
+	while (k_msgq_get(&chunk_q, &c, K_NO_WAIT) == 0) {
+		zassert_ok(spi_flash_en25_bulk_read_release(flash_dev, c.data));
+	}
+}
@@ -0,0 +1,59 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define COPY_SRC_OFFSET (ERASE_SECTOR_SIZE * 14)
+#define COPY_DST_OFFSET (ERASE_SECTOR_SIZE * 16)
+#define COPY_SIZE	(ERASE_SECTOR_SIZE * 2)
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t pattern[COPY_SIZE];
+static uint8_t read_buf[COPY_SIZE];
+
+static void *copy_suite_setup(void)
+{
+	int err;
+
+	for (int i = 0; i < COPY_SIZE; i++) {
+		pattern[i] = (uint8_t)(i * 3 + (i >> 8));
+	}
+
+	err = flash_erase(flash_dev, COPY_SRC_OFFSET, COPY_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	err = flash_write(flash_dev, COPY_SRC_OFFSET, pattern, COPY_SIZE);
+	zassert_equal(err, 0, "Flash write failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_copy_suite, NULL, copy_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_copy_suite, test_copy_with_erase)
+{
+	int err;
+
+	err = spi_flash_en25_copy(flash_dev, COPY_SRC_OFFSET, COPY_DST_OFFSET, COPY_SIZE, true);
+	zassert_equal(err, 0, "Copy failed");
+
+	err = flash_read(flash_dev, COPY_DST_OFFSET, read_buf, COPY_SIZE);
+	zassert_equal(err, 0, "Flash read failed");
+	zassert_mem_equal(read_buf, pattern, COPY_SIZE, "Copied data differs");
+}
+
+ZTEST(flash_copy_suite, test_copy_invalid_regions)
+{
+	int err;
+
+	err = spi_flash_en25_copy(flash_dev, COPY_SRC_OFFSET, COPY_SRC_OFFSET + 16, 64, false);
+	zassert_equal(err, -EINVAL, "Overlapping copy was not rejected");
+
+	err = spi_flash_en25_copy(flash_dev, COPY_SRC_OFFSET, COPY_DST_OFFSET + 1, 64, true);
+	zassert_equal(err, -EINVAL, "Unaligned erase was not rejected");
+}
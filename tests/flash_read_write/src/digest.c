@@ -0,0 +1,53 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define DIGEST_REGION_OFFSET (ERASE_SECTOR_SIZE * 12)
+#define DIGEST_REGION_SIZE   (ERASE_SECTOR_SIZE * 2)
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t pattern[DIGEST_REGION_SIZE];
+
+static void *digest_suite_setup(void)
+{
+	int err;
+
+	for (int i = 0; i < DIGEST_REGION_SIZE; i++) {
+		pattern[i] = (uint8_t)(i * 13 + 1);
+	}
+
+	err = flash_erase(flash_dev, DIGEST_REGION_OFFSET, DIGEST_REGION_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_digest_suite, NULL, digest_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_digest_suite, test_write_verify_and_crc32)
+{
+	int err;
+	uint32_t crc = 0;
+
+	/* Unaligned start, so the first and last page are only partially programmed */
+	err = spi_flash_en25_write_verify(flash_dev, DIGEST_REGION_OFFSET + 3, pattern + 3,
+					  DIGEST_REGION_SIZE - 3);
+	zassert_equal(err, 0, "Verified write failed");
+
+	err = spi_flash_en25_crc32(flash_dev, DIGEST_REGION_OFFSET + 3, DIGEST_REGION_SIZE - 3,
+				   &crc);
+	zassert_equal(err, 0, "CRC32 calculation failed");
+	zassert_equal(crc, crc32_ieee(pattern + 3, DIGEST_REGION_SIZE - 3), "CRC32 mismatch");
+
+	/* Programming over already programmed data can not produce the source data */
+	pattern[10] = 0xFF;
+	err = spi_flash_en25_write_verify(flash_dev, DIGEST_REGION_OFFSET, pattern, 16);
+	zassert_equal(err, -EIO, "Verify did not detect the mismatch");
+}
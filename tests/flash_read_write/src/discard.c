@@ -0,0 +1,123 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define DISCARD_REGION_OFFSET (ERASE_SECTOR_SIZE * 20)
+#define DISCARD_REGION_SIZE   (ERASE_SECTOR_SIZE * 2)
+#define TEST_DATA_LEN	      64
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t test_data[TEST_DATA_LEN];
+static uint8_t read_data[TEST_DATA_LEN];
+
+static void *discard_suite_setup(void)
+{
+	int err;
+
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		test_data[i] = i;
+	}
+
+	err = flash_erase(flash_dev, DISCARD_REGION_OFFSET, DISCARD_REGION_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_discard_suite, NULL, discard_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_discard_suite, test_discard_alignment)
+{
+	int err;
+
+	err = spi_flash_en25_discard(flash_dev, DISCARD_REGION_OFFSET + 1, ERASE_SECTOR_SIZE);
+	zassert_equal(err, -EINVAL, "Unaligned discard accepted");
+
+	err = spi_flash_en25_discard(flash_dev, DISCARD_REGION_OFFSET, ERASE_SECTOR_SIZE - 1);
+	zassert_equal(err, -EINVAL, "Unaligned discard size accepted");
+}
+
+ZTEST(flash_discard_suite, test_write_discarded)
+{
+	int err;
+
+	err = flash_write(flash_dev, DISCARD_REGION_OFFSET, test_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = spi_flash_en25_discard(flash_dev, DISCARD_REGION_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Discard failed");
+
+	/* Writing to a discarded sector before it was erased must erase it first */
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		test_data[i] = ~i;
+	}
+
+	err = flash_write(flash_dev, DISCARD_REGION_OFFSET, test_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = flash_read(flash_dev, DISCARD_REGION_OFFSET, read_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash read failed");
+	zassert_mem_equal(read_data, test_data, TEST_DATA_LEN, "Read data does not match");
+}
+
+ZTEST(flash_discard_suite, test_update_discarded)
+{
+	enum spi_flash_en25_update_path path;
+	uint8_t old_data[TEST_DATA_LEN];
+	uint8_t new_data[TEST_DATA_LEN];
+	int err;
+
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		old_data[i] = i;
+		/* Unchanged at both ends, only clears bits in between */
+		new_data[i] = (i < 8 || i >= TEST_DATA_LEN - 8) ? i : (i & 0x0F);
+	}
+
+	err = flash_erase(flash_dev, DISCARD_REGION_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	err = flash_write(flash_dev, DISCARD_REGION_OFFSET, old_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = spi_flash_en25_discard(flash_dev, DISCARD_REGION_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Discard failed");
+
+	err = spi_flash_en25_update(flash_dev, DISCARD_REGION_OFFSET, new_data, TEST_DATA_LEN,
+				    &path);
+	zassert_equal(err, 0, "Update failed");
+	zassert_equal(path, SPI_FLASH_EN25_UPDATE_ERASED, "Discarded sector updated in place");
+
+	err = flash_read(flash_dev, DISCARD_REGION_OFFSET, read_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash read failed");
+	zassert_mem_equal(read_data, new_data, TEST_DATA_LEN, "Unchanged bytes were lost");
+}
+
+ZTEST(flash_discard_suite, test_background_erase)
+{
+	int err;
+
+	err = flash_write(flash_dev, DISCARD_REGION_OFFSET + ERASE_SECTOR_SIZE, test_data,
+			  TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = spi_flash_en25_discard(flash_dev, DISCARD_REGION_OFFSET + ERASE_SECTOR_SIZE,
+				     ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Discard failed");
+
+	/* Idle timeout plus plenty of time for a sector erase */
+	k_sleep(K_MSEC(CONFIG_SPI_FLASH_EN25_DISCARD_IDLE_TIMEOUT + 1000));
+
+	err = flash_read(flash_dev, DISCARD_REGION_OFFSET + ERASE_SECTOR_SIZE, read_data,
+			 TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash read failed");
+
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		zassert_equal(read_data[i], 0xff, "Discarded sector was not erased");
+	}
+}
@@ -0,0 +1,115 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define FLASH_NODE DT_NODELABEL(en25qh32b)
+
+#define REGION_OFFSET DT_PROP_BY_IDX(FLASH_NODE, emergency_save_region, 0)
+#define REGION_SIZE   DT_PROP_BY_IDX(FLASH_NODE, emergency_save_region, 1)
+
+/* Not page aligned, so the last page is partial */
+#define SNAPSHOT_LEN 1000
+#define DEADLINE_US  20000
+
+/* A 64 KiB block erase takes far longer than the deadline */
+#define BUSY_OFFSET 0x100000
+#define BUSY_SIZE   DT_PROP(FLASH_NODE, erase_full_block_size)
+
+static const struct device *flash_dev = DEVICE_DT_GET(FLASH_NODE);
+
+static uint8_t snapshot[SNAPSHOT_LEN];
+static uint8_t read_data[SNAPSHOT_LEN];
+
+static K_THREAD_STACK_DEFINE(eraser_stack, 1024);
+static struct k_thread eraser_thread;
+static int eraser_err;
+
+static void wait_armed(void)
+{
+	for (int i = 0; i < 100 && !spi_flash_en25_emergency_is_armed(flash_dev); i++) {
+		k_msleep(50);
+	}
+
+	zassert_true(spi_flash_en25_emergency_is_armed(flash_dev), "Region not armed");
+}
+
+static void *emergency_suite_setup(void)
+{
+	for (size_t i = 0; i < sizeof(snapshot); i++) {
+		snapshot[i] = i * 3 + 1;
+	}
+
+	return NULL;
+}
+
+static void emergency_before(void *fixture)
+{
+	/* The region may hold a snapshot of an earlier run */
+	zassert_ok(spi_flash_en25_emergency_rearm(flash_dev));
+	wait_armed();
+}
+
+ZTEST_SUITE(flash_emergency_suite, NULL, emergency_suite_setup, emergency_before, NULL, NULL);
+
+ZTEST(flash_emergency_suite, test_emergency_save)
+{
+	size_t written;
+	bool blank;
+
+	zassert_ok(spi_flash_en25_emergency_save(flash_dev, snapshot, sizeof(snapshot), DEADLINE_US,
+						 &written));
+	zassert_equal(written, sizeof(snapshot), "Only %zu bytes written", written);
+
+	zassert_ok(flash_read(flash_dev, REGION_OFFSET, read_data, sizeof(read_data)));
+	zassert_mem_equal(read_data, snapshot, sizeof(snapshot), "Snapshot corrupted");
+
+	/* The snapshot is kept until the region is re-armed */
+	zassert_false(spi_flash_en25_emergency_is_armed(flash_dev), "Still armed");
+	zassert_equal(spi_flash_en25_emergency_save(flash_dev, snapshot, sizeof(snapshot),
+						    DEADLINE_US, &written),
+		      -EAGAIN, "Saved over a snapshot");
+
+	zassert_ok(spi_flash_en25_emergency_rearm(flash_dev));
+	wait_armed();
+	zassert_ok(spi_flash_en25_is_blank(flash_dev, REGION_OFFSET, REGION_SIZE, &blank));
+	zassert_true(blank, "Region not erased");
+}
+
+ZTEST(flash_emergency_suite, test_emergency_save_too_long)
+{
+	size_t written;
+
+	zassert_equal(spi_flash_en25_emergency_save(flash_dev, snapshot, REGION_SIZE + 1,
+						    DEADLINE_US, &written),
+		      -EINVAL, "Block larger than the region accepted");
+	zassert_true(spi_flash_en25_emergency_is_armed(flash_dev), "Region used");
+}
+
+static void eraser_entry(void *p1, void *p2, void *p3)
+{
+	eraser_err = flash_erase(flash_dev, BUSY_OFFSET, BUSY_SIZE);
+}
+
+ZTEST(flash_emergency_suite, test_emergency_save_aborts_erase)
+{
+	size_t written;
+
+	k_thread_create(&eraser_thread, eraser_stack, K_THREAD_STACK_SIZEOF(eraser_stack),
+			eraser_entry, NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+
+	/* Let the erase start */
+	k_msleep(5);
+
+	zassert_ok(spi_flash_en25_emergency_save(flash_dev, snapshot, sizeof(snapshot), DEADLINE_US,
+						 &written));
+	zassert_equal(written, sizeof(snapshot), "Only %zu bytes written", written);
+
+	zassert_ok(k_thread_join(&eraser_thread, K_SECONDS(5)));
+	zassert_not_equal(eraser_err, 0, "Erase was not aborted");
+
+	zassert_ok(flash_read(flash_dev, REGION_OFFSET, read_data, sizeof(read_data)));
+	zassert_mem_equal(read_data, snapshot, sizeof(snapshot), "Snapshot corrupted");
+}
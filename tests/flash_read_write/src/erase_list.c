@@ -0,0 +1,114 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define ERASE_LIST_FIRST_SECTOR 30
+#define ERASE_LIST_SECTORS	6
+#define TEST_DATA_LEN		64
+
+#define SECTOR_OFFSET(n) (ERASE_SECTOR_SIZE * (ERASE_LIST_FIRST_SECTOR + (n)))
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t test_data[TEST_DATA_LEN];
+static uint8_t read_data[TEST_DATA_LEN];
+
+static void fill_sectors(void)
+{
+	int err;
+
+	err = flash_erase(flash_dev, SECTOR_OFFSET(0), ERASE_LIST_SECTORS * ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	for (int i = 0; i < ERASE_LIST_SECTORS; i++) {
+		err = flash_write(flash_dev, SECTOR_OFFSET(i), test_data, TEST_DATA_LEN);
+		zassert_equal(err, 0, "Flash write failed");
+	}
+}
+
+static bool sector_erased(int n)
+{
+	int err = flash_read(flash_dev, SECTOR_OFFSET(n), read_data, TEST_DATA_LEN);
+
+	zassert_equal(err, 0, "Flash read failed");
+
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		if (read_data[i] != 0xFF) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void *erase_list_suite_setup(void)
+{
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		test_data[i] = i ^ 0x55;
+	}
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_erase_list_suite, NULL, erase_list_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_erase_list_suite, test_erase_list)
+{
+	struct spi_flash_en25_erase_range ranges[] = {
+		{.offset = SECTOR_OFFSET(4), .size = ERASE_SECTOR_SIZE},
+		{.offset = SECTOR_OFFSET(0), .size = ERASE_SECTOR_SIZE},
+		/* Overlaps and extends the previous one */
+		{.offset = SECTOR_OFFSET(0), .size = 2 * ERASE_SECTOR_SIZE},
+	};
+	uint32_t busy_us;
+	int err;
+
+	fill_sectors();
+
+	err = spi_flash_en25_erase_list(flash_dev, ranges, ARRAY_SIZE(ranges), &busy_us);
+	zassert_equal(err, 0, "Erase list failed");
+	zassert_true(busy_us > 0, "No busy time reported");
+
+	/* Sorted in place */
+	zassert_equal(ranges[0].offset, SECTOR_OFFSET(0), "Ranges not sorted");
+	zassert_equal(ranges[2].offset, SECTOR_OFFSET(4), "Ranges not sorted");
+
+	for (int i = 0; i < ARRAY_SIZE(ranges); i++) {
+		zassert_equal(ranges[i].result, 0, "Range %d failed", i);
+	}
+
+	zassert_true(sector_erased(0), "Sector 0 not erased");
+	zassert_true(sector_erased(1), "Sector 1 not erased");
+	zassert_false(sector_erased(2), "Sector 2 erased");
+	zassert_false(sector_erased(3), "Sector 3 erased");
+	zassert_true(sector_erased(4), "Sector 4 not erased");
+	zassert_false(sector_erased(5), "Sector 5 erased");
+}
+
+ZTEST(flash_erase_list_suite, test_erase_list_invalid_ranges)
+{
+	struct spi_flash_en25_erase_range ranges[] = {
+		{.offset = SECTOR_OFFSET(3), .size = ERASE_SECTOR_SIZE - 1},
+		{.offset = SECTOR_OFFSET(2), .size = ERASE_SECTOR_SIZE},
+		{.offset = -ERASE_SECTOR_SIZE, .size = ERASE_SECTOR_SIZE},
+	};
+	int err;
+
+	fill_sectors();
+
+	err = spi_flash_en25_erase_list(flash_dev, ranges, ARRAY_SIZE(ranges), NULL);
+	zassert_equal(err, -ENODEV, "Out of range error not reported first");
+
+	zassert_equal(ranges[0].result, -ENODEV, "Out of range accepted");
+	zassert_equal(ranges[1].result, 0, "Valid range failed");
+	zassert_equal(ranges[2].result, -EINVAL, "Unaligned range accepted");
+
+	/* Invalid ranges do not keep the valid ones from being erased */
+	zassert_true(sector_erased(2), "Sector 2 not erased");
+	zassert_false(sector_erased(3), "Sector 3 erased");
+}
@@ -0,0 +1,96 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+#define WRITE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), write_sector_size)
+
+#define HEATMAP_SECTOR 36
+#define HEATMAP_OFFSET (ERASE_SECTOR_SIZE * HEATMAP_SECTOR)
+#define TEST_DATA_LEN  64
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t test_data[TEST_DATA_LEN];
+
+static void *heatmap_suite_setup(void)
+{
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		test_data[i] = i;
+	}
+
+	return NULL;
+}
+
+static void heatmap_before(void *fixture)
+{
+	spi_flash_en25_heatmap_reset(flash_dev);
+}
+
+ZTEST_SUITE(flash_heatmap_suite, NULL, heatmap_suite_setup, heatmap_before, NULL, NULL);
+
+ZTEST(flash_heatmap_suite, test_heatmap_counts)
+{
+	struct spi_flash_en25_heatmap_entry entries[2];
+	struct spi_flash_en25_heatmap_summary summary;
+	int err;
+
+	err = flash_erase(flash_dev, HEATMAP_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	/* Crosses a page boundary, so it takes two page programs */
+	err = flash_write(flash_dev, HEATMAP_OFFSET + WRITE_SECTOR_SIZE - TEST_DATA_LEN / 2,
+			  test_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = spi_flash_en25_heatmap_get(flash_dev, HEATMAP_SECTOR, entries, ARRAY_SIZE(entries));
+	zassert_equal(err, 0, "Reading counters failed");
+
+	zassert_equal(entries[0].erases, 1, "Erase not counted");
+	zassert_equal(entries[0].programs, 2, "Page programs not counted");
+	zassert_equal(entries[0].bytes, TEST_DATA_LEN, "Bytes not counted");
+	zassert_equal(entries[1].erases, 0, "Neighbouring sector counted");
+	zassert_equal(entries[1].programs, 0, "Neighbouring sector counted");
+
+	err = spi_flash_en25_heatmap_summary_get(flash_dev, &summary);
+	zassert_equal(err, 0, "Reading summary failed");
+
+	zassert_equal(summary.sector_size, ERASE_SECTOR_SIZE, "Wrong sector size");
+	zassert_equal(summary.bytes_requested, TEST_DATA_LEN, "Requested bytes not counted");
+	zassert_equal(summary.bytes_programmed, TEST_DATA_LEN, "Programmed bytes not counted");
+	zassert_equal(summary.write_amplification_milli, 1000, "Wrong write amplification");
+	zassert_equal(summary.hottest_sector, HEATMAP_SECTOR, "Wrong hottest sector");
+}
+
+ZTEST(flash_heatmap_suite, test_heatmap_reset)
+{
+	struct spi_flash_en25_heatmap_summary summary;
+	int err;
+
+	err = flash_erase(flash_dev, HEATMAP_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	spi_flash_en25_heatmap_reset(flash_dev);
+
+	err = spi_flash_en25_heatmap_summary_get(flash_dev, &summary);
+	zassert_equal(err, 0, "Reading summary failed");
+
+	zassert_equal(summary.total_erases, 0, "Erases not cleared");
+	zassert_equal(summary.bytes_requested, 0, "Requested bytes not cleared");
+	zassert_equal(summary.write_amplification_milli, 0, "Write amplification not cleared");
+}
+
+ZTEST(flash_heatmap_suite, test_heatmap_out_of_range)
+{
+	struct spi_flash_en25_heatmap_summary summary;
+	struct spi_flash_en25_heatmap_entry entry;
+	int err;
+
+	spi_flash_en25_heatmap_summary_get(flash_dev, &summary);
+
+	err = spi_flash_en25_heatmap_get(flash_dev, summary.sectors, &entry, 1);
+	zassert_equal(err, -EINVAL, "Out of range sector accepted");
+}
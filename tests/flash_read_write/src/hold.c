@@ -0,0 +1,60 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_HOLD_PREEMPT)
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define HOLD_REGION_OFFSET (ERASE_SECTOR_SIZE * 28)
+#define TEST_DATA_LEN	   ERASE_SECTOR_SIZE
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t test_data[TEST_DATA_LEN];
+static uint8_t read_buf[TEST_DATA_LEN];
+
+static void *hold_suite_setup(void)
+{
+	int err;
+
+	for (size_t i = 0; i < TEST_DATA_LEN; i++) {
+		test_data[i] = (i * 7) ^ (i >> 8);
+	}
+
+	err = flash_erase(flash_dev, HOLD_REGION_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	err = flash_write(flash_dev, HOLD_REGION_OFFSET, test_data, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash write failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_hold_suite, NULL, hold_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_hold_suite, test_paused_read)
+{
+	int err;
+
+	memset(read_buf, 0, sizeof(read_buf));
+
+	/* Long enough to be paused many times at the configured block time */
+	err = flash_read(flash_dev, HOLD_REGION_OFFSET, read_buf, TEST_DATA_LEN);
+	zassert_equal(err, 0, "Flash read failed");
+	zassert_mem_equal(read_buf, test_data, TEST_DATA_LEN, "Read data does not match");
+}
+
+ZTEST(flash_hold_suite, test_paused_read_unaligned)
+{
+	int err;
+
+	memset(read_buf, 0, sizeof(read_buf));
+
+	err = flash_read(flash_dev, HOLD_REGION_OFFSET + 3, read_buf, TEST_DATA_LEN - 5);
+	zassert_equal(err, 0, "Flash read failed");
+	zassert_mem_equal(read_buf, &test_data[3], TEST_DATA_LEN - 5, "Read data does not match");
+}
+
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_HOLD_PREEMPT) */
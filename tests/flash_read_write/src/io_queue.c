@@ -0,0 +1,78 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define QUEUE_REGION_OFFSET (ERASE_SECTOR_SIZE * 22)
+#define QUEUE_REGION_SIZE   ERASE_SECTOR_SIZE
+
+#define WORKER_COUNT	  4
+#define WORKER_CHUNK_LEN  32
+#define WORKER_STACK_SIZE 1024
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, WORKER_COUNT, WORKER_STACK_SIZE);
+static struct k_thread worker_threads[WORKER_COUNT];
+static int worker_err[WORKER_COUNT];
+
+static uint8_t test_data[WORKER_COUNT * WORKER_CHUNK_LEN];
+static uint8_t read_data[WORKER_COUNT * WORKER_CHUNK_LEN];
+
+static void *io_queue_suite_setup(void)
+{
+	int err;
+
+	for (size_t i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = i * 7;
+	}
+
+	err = flash_erase(flash_dev, QUEUE_REGION_OFFSET, QUEUE_REGION_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_io_queue_suite, NULL, io_queue_suite_setup, NULL, NULL, NULL);
+
+static void writer(void *p1, void *p2, void *p3)
+{
+	size_t idx = (size_t)p1;
+	off_t offset = idx * WORKER_CHUNK_LEN;
+
+	worker_err[idx] = flash_write(flash_dev, QUEUE_REGION_OFFSET + offset, &test_data[offset],
+				      WORKER_CHUNK_LEN);
+}
+
+static void reader(void *p1, void *p2, void *p3)
+{
+	size_t idx = (size_t)p1;
+	off_t offset = idx * WORKER_CHUNK_LEN;
+
+	worker_err[idx] = flash_read(flash_dev, QUEUE_REGION_OFFSET + offset, &read_data[offset],
+				     WORKER_CHUNK_LEN);
+}
+
+static void run_workers(k_thread_entry_t entry)
+{
+	for (size_t i = 0; i < WORKER_COUNT; i++) {
+		k_thread_create(&worker_threads[i], worker_stacks[i], WORKER_STACK_SIZE, entry,
+				(void *)i, NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+	}
+
+	for (size_t i = 0; i < WORKER_COUNT; i++) {
+		k_thread_join(&worker_threads[i], K_FOREVER);
+		zassert_equal(worker_err[i], 0, "Worker %zu failed", i);
+	}
+}
+
+ZTEST(flash_io_queue_suite, test_concurrent_contiguous_requests)
+{
+	/* Chunks are contiguous and within one page, so the queue may merge them */
+	run_workers(writer);
+	run_workers(reader);
+
+	zassert_mem_equal(read_data, test_data, sizeof(test_data), "Read data does not match");
+}
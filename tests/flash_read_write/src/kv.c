@@ -0,0 +1,135 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define FLASH_NODE	  DT_NODELABEL(en25qh32b)
+#define ERASE_SECTOR_SIZE DT_PROP(FLASH_NODE, erase_sector_size)
+
+#define KV_FIRST_SECTOR 52
+#define KV_SECTORS	4
+#define KV_OFFSET	(KV_FIRST_SECTOR * ERASE_SECTOR_SIZE)
+#define KV_SIZE		(KV_SECTORS * ERASE_SECTOR_SIZE)
+#define MAX_KEYS	8
+
+/* Spans two write sectors with the record header */
+#define CALIBRATION_LEN 300
+
+SPI_FLASH_EN25_KV_STORE_DEFINE(store, FLASH_NODE, KV_OFFSET, KV_SIZE, MAX_KEYS);
+
+static const struct device *flash_dev = DEVICE_DT_GET(FLASH_NODE);
+
+static uint8_t calibration[CALIBRATION_LEN];
+static uint8_t read_data[CALIBRATION_LEN];
+
+static void *kv_suite_setup(void)
+{
+	for (size_t i = 0; i < sizeof(calibration); i++) {
+		calibration[i] = i * 7;
+	}
+
+	return NULL;
+}
+
+static void kv_before(void *fixture)
+{
+	zassert_ok(flash_erase(flash_dev, KV_OFFSET, KV_SIZE));
+	zassert_ok(spi_flash_en25_kv_store_init(&store));
+}
+
+ZTEST_SUITE(flash_kv_suite, NULL, kv_suite_setup, kv_before, NULL, NULL);
+
+ZTEST(flash_kv_suite, test_kv_roundtrip)
+{
+	uint32_t interval = 60;
+	int len;
+
+	zassert_ok(spi_flash_en25_kv_write(&store, 1, &interval, sizeof(interval)));
+	zassert_ok(spi_flash_en25_kv_write(&store, 2, calibration, sizeof(calibration)));
+	zassert_equal(spi_flash_en25_kv_count_get(&store), 2, "Wrong key count");
+
+	interval = 0;
+	len = spi_flash_en25_kv_read(&store, 1, &interval, sizeof(interval));
+	zassert_equal(len, sizeof(interval), "Read failed: %d", len);
+	zassert_equal(interval, 60, "Wrong value");
+
+	len = spi_flash_en25_kv_read(&store, 2, read_data, sizeof(read_data));
+	zassert_equal(len, sizeof(calibration), "Read failed: %d", len);
+	zassert_mem_equal(read_data, calibration, sizeof(calibration), "Calibration corrupted");
+
+	zassert_equal(spi_flash_en25_kv_read(&store, 2, read_data, 10), -ENOMEM,
+		      "Short buffer accepted");
+	zassert_equal(spi_flash_en25_kv_read(&store, 3, read_data, sizeof(read_data)), -ENOENT,
+		      "Missing key found");
+}
+
+ZTEST(flash_kv_suite, test_kv_update_and_delete)
+{
+	uint32_t interval = 60;
+
+	zassert_ok(spi_flash_en25_kv_write(&store, 1, &interval, sizeof(interval)));
+	zassert_ok(spi_flash_en25_kv_write(&store, 2, calibration, sizeof(calibration)));
+
+	interval = 120;
+	zassert_ok(spi_flash_en25_kv_write(&store, 1, &interval, sizeof(interval)));
+	zassert_ok(spi_flash_en25_kv_delete(&store, 2));
+	zassert_equal(spi_flash_en25_kv_delete(&store, 2), -ENOENT, "Deleted twice");
+
+	interval = 0;
+	zassert_equal(spi_flash_en25_kv_read(&store, 1, &interval, sizeof(interval)),
+		      sizeof(interval), "Read failed");
+	zassert_equal(interval, 120, "Old value returned");
+	zassert_equal(spi_flash_en25_kv_read(&store, 2, read_data, sizeof(read_data)), -ENOENT,
+		      "Deleted key found");
+	zassert_equal(spi_flash_en25_kv_count_get(&store), 1, "Wrong key count");
+}
+
+ZTEST(flash_kv_suite, test_kv_remount)
+{
+	uint32_t interval = 60;
+
+	zassert_ok(spi_flash_en25_kv_write(&store, 1, &interval, sizeof(interval)));
+	interval = 120;
+	zassert_ok(spi_flash_en25_kv_write(&store, 1, &interval, sizeof(interval)));
+	zassert_ok(spi_flash_en25_kv_write(&store, 2, calibration, sizeof(calibration)));
+	zassert_ok(spi_flash_en25_kv_write(&store, 3, calibration, 16));
+	zassert_ok(spi_flash_en25_kv_delete(&store, 3));
+
+	/* The index is rebuilt from flash */
+	zassert_ok(spi_flash_en25_kv_store_init(&store));
+	zassert_equal(spi_flash_en25_kv_count_get(&store), 2, "Wrong key count");
+
+	interval = 0;
+	zassert_equal(spi_flash_en25_kv_read(&store, 1, &interval, sizeof(interval)),
+		      sizeof(interval), "Read failed");
+	zassert_equal(interval, 120, "Old value returned");
+	zassert_equal(spi_flash_en25_kv_read(&store, 2, read_data, sizeof(read_data)),
+		      sizeof(calibration), "Read failed");
+	zassert_mem_equal(read_data, calibration, sizeof(calibration), "Calibration corrupted");
+	zassert_equal(spi_flash_en25_kv_read(&store, 3, read_data, sizeof(read_data)), -ENOENT,
+		      "Deleted key found");
+}
+
+ZTEST(flash_kv_suite, test_kv_compaction)
+{
+	uint32_t counter;
+
+	zassert_ok(spi_flash_en25_kv_write(&store, 2, calibration, sizeof(calibration)));
+
+	/* Goes around the ring several times, so the calibration is copied forward */
+	for (counter = 0; counter < 200; counter++) {
+		zassert_ok(spi_flash_en25_kv_write(&store, 1, &counter, sizeof(counter)));
+	}
+
+	zassert_ok(spi_flash_en25_kv_store_init(&store));
+
+	counter = 0;
+	zassert_equal(spi_flash_en25_kv_read(&store, 1, &counter, sizeof(counter)),
+		      sizeof(counter), "Read failed");
+	zassert_equal(counter, 199, "Wrong value");
+	zassert_equal(spi_flash_en25_kv_read(&store, 2, read_data, sizeof(read_data)),
+		      sizeof(calibration), "Read failed");
+	zassert_mem_equal(read_data, calibration, sizeof(calibration), "Calibration lost");
+}
@@ -23,7 +23,15 @@ static uint8_t erase_check_buf[ERASE_BUF_SIZE];
 
 const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
 
-ZTEST_SUITE(flash_test_suite, NULL, NULL, NULL, NULL, NULL);
+static void flash_test_after(void *fixture)
+{
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+	/* test_low_power suspends the flash, every other suite expects it active */
+	(void)pm_device_action_run(flash_dev, PM_DEVICE_ACTION_RESUME);
+#endif
+}
+
+ZTEST_SUITE(flash_test_suite, NULL, NULL, NULL, flash_test_after, NULL);
 
 ZTEST(flash_test_suite, test_full_erase_full_read_write)
 {
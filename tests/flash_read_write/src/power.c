@@ -0,0 +1,49 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define SUSPEND_TIME_MS 50
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static void power_after(void *fixture)
+{
+	/* Do not leave the flash suspended for the other suites, even if a test failed */
+	(void)pm_device_action_run(flash_dev, PM_DEVICE_ACTION_RESUME);
+}
+
+ZTEST_SUITE(flash_power_suite, NULL, NULL, NULL, power_after, NULL);
+
+ZTEST(flash_power_suite, test_dpd_residency)
+{
+	struct spi_flash_en25_power_stats stats;
+	uint8_t buf[16];
+	int err;
+
+	err = spi_flash_en25_power_stats_get(flash_dev, &stats, true);
+	zassert_equal(err, 0, "Getting stats failed");
+
+	err = pm_device_action_run(flash_dev, PM_DEVICE_ACTION_SUSPEND);
+	zassert_equal(err, 0, "Suspend failed");
+
+	k_msleep(SUSPEND_TIME_MS);
+
+	err = pm_device_action_run(flash_dev, PM_DEVICE_ACTION_RESUME);
+	zassert_equal(err, 0, "Resume failed");
+
+	err = flash_read(flash_dev, 0, buf, sizeof(buf));
+	zassert_equal(err, 0, "Flash read failed");
+
+	err = spi_flash_en25_power_stats_get(flash_dev, &stats, false);
+	zassert_equal(err, 0, "Getting stats failed");
+
+	zassert_equal(stats.wake_count, 1, "Unexpected wake count");
+	zassert_true(stats.residency_us[SPI_FLASH_EN25_POWER_DPD] >= (SUSPEND_TIME_MS - 1) * 1000,
+		     "Deep power-down time not accounted");
+	zassert_true(stats.residency_us[SPI_FLASH_EN25_POWER_ACTIVE] > 0,
+		     "Read time not accounted");
+}
@@ -0,0 +1,70 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define PREFETCH_REGION_OFFSET (ERASE_SECTOR_SIZE * 10)
+#define PREFETCH_REGION_SIZE   (ERASE_SECTOR_SIZE * 2)
+#define CHUNK_SIZE	       20
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t pattern[PREFETCH_REGION_SIZE];
+static uint8_t read_buf[PREFETCH_REGION_SIZE];
+
+static void *prefetch_suite_setup(void)
+{
+	int err;
+
+	for (int i = 0; i < PREFETCH_REGION_SIZE; i++) {
+		pattern[i] = (uint8_t)(i * 7);
+	}
+
+	err = flash_erase(flash_dev, PREFETCH_REGION_OFFSET, PREFETCH_REGION_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	err = flash_write(flash_dev, PREFETCH_REGION_OFFSET, pattern, PREFETCH_REGION_SIZE);
+	zassert_equal(err, 0, "Flash write failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_prefetch_suite, NULL, prefetch_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_prefetch_suite, test_sequential_reads)
+{
+	int err;
+
+	/* Odd chunk size, so reads straddle the prefetch window boundary */
+	for (size_t pos = 0; pos < PREFETCH_REGION_SIZE; pos += CHUNK_SIZE) {
+		size_t len = MIN(CHUNK_SIZE, PREFETCH_REGION_SIZE - pos);
+
+		err = flash_read(flash_dev, PREFETCH_REGION_OFFSET + pos, &read_buf[pos], len);
+		zassert_equal(err, 0, "Flash read failed at %zu", pos);
+	}
+
+	zassert_mem_equal(read_buf, pattern, PREFETCH_REGION_SIZE, "Read data differs");
+}
+
+ZTEST(flash_prefetch_suite, test_write_invalidates_window)
+{
+	int err;
+	uint8_t data[CHUNK_SIZE];
+	uint8_t zeros[CHUNK_SIZE] = {0};
+
+	/* Two sequential reads, so the second one fills the prefetch window */
+	err = flash_read(flash_dev, PREFETCH_REGION_OFFSET, data, CHUNK_SIZE);
+	zassert_equal(err, 0, "Flash read failed");
+	err = flash_read(flash_dev, PREFETCH_REGION_OFFSET + CHUNK_SIZE, data, CHUNK_SIZE);
+	zassert_equal(err, 0, "Flash read failed");
+
+	/* Clearing bits is possible without an erase */
+	err = flash_write(flash_dev, PREFETCH_REGION_OFFSET + 2 * CHUNK_SIZE, zeros, CHUNK_SIZE);
+	zassert_equal(err, 0, "Flash write failed");
+
+	err = flash_read(flash_dev, PREFETCH_REGION_OFFSET + 2 * CHUNK_SIZE, data, CHUNK_SIZE);
+	zassert_equal(err, 0, "Flash read failed");
+	zassert_mem_equal(data, zeros, CHUNK_SIZE, "Stale data returned after write");
+}
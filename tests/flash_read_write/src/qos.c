@@ -0,0 +1,67 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#if IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS)
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+#define QOS_REGION_OFFSET (ERASE_SECTOR_SIZE * 24)
+#define QOS_READ_LEN	  2048
+#define QOS_BYTE_RATE	  4096
+
+/* The bucket starts with a burst worth of budget, the rest must be waited for */
+#define QOS_BURST_BYTES (QOS_BYTE_RATE * CONFIG_SPI_FLASH_EN25_QOS_BURST_MS / MSEC_PER_SEC)
+#define QOS_MIN_READ_MS (((QOS_READ_LEN - QOS_BURST_BYTES) * MSEC_PER_SEC / QOS_BYTE_RATE) - 10)
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t read_data[QOS_READ_LEN];
+
+static void qos_after(void *fixture)
+{
+	(void)spi_flash_en25_qos_attach(flash_dev, k_current_get(), SPI_FLASH_EN25_QOS_NORMAL);
+	(void)spi_flash_en25_qos_set_budget(flash_dev, SPI_FLASH_EN25_QOS_BULK, 0, 0);
+}
+
+ZTEST_SUITE(flash_qos_suite, NULL, NULL, NULL, qos_after, NULL);
+
+ZTEST(flash_qos_suite, test_invalid_class)
+{
+	int err;
+
+	err = spi_flash_en25_qos_attach(flash_dev, k_current_get(), SPI_FLASH_EN25_QOS_CLASS_COUNT);
+	zassert_equal(err, -EINVAL, "Invalid class accepted");
+}
+
+ZTEST(flash_qos_suite, test_bulk_throttled)
+{
+	struct spi_flash_en25_qos_stats stats;
+	int64_t start;
+	int err;
+
+	err = spi_flash_en25_qos_attach(flash_dev, k_current_get(), SPI_FLASH_EN25_QOS_BULK);
+	zassert_equal(err, 0, "Attach failed");
+
+	err = spi_flash_en25_qos_set_budget(flash_dev, SPI_FLASH_EN25_QOS_BULK, QOS_BYTE_RATE, 0);
+	zassert_equal(err, 0, "Setting budget failed");
+
+	(void)spi_flash_en25_qos_get_stats(flash_dev, SPI_FLASH_EN25_QOS_BULK, &stats, true);
+
+	start = k_uptime_get();
+	err = flash_read(flash_dev, QOS_REGION_OFFSET, read_data, QOS_READ_LEN);
+	zassert_equal(err, 0, "Flash read failed");
+
+	zassert_true(k_uptime_get() - start >= QOS_MIN_READ_MS, "Read was not throttled");
+
+	err = spi_flash_en25_qos_get_stats(flash_dev, SPI_FLASH_EN25_QOS_BULK, &stats, false);
+	zassert_equal(err, 0, "Getting stats failed");
+	zassert_equal(stats.ops, 1, "Unexpected operation count");
+	zassert_equal(stats.bytes, QOS_READ_LEN, "Unexpected byte count");
+	zassert_true(stats.throttled_ms > 0, "Throttling not accounted");
+}
+
+#endif /* IS_ENABLED(CONFIG_SPI_FLASH_EN25_QOS) */
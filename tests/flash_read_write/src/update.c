@@ -0,0 +1,72 @@
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <spi_flash_en25.h>
+
+#define ERASE_SECTOR_SIZE DT_PROP(DT_NODELABEL(en25qh32b), erase_sector_size)
+
+/* Keep away from the region used by the read/write suite */
+#define UPDATE_REGION_OFFSET (ERASE_SECTOR_SIZE * 8)
+#define UPDATE_LEN	     64
+
+static const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(en25qh32b));
+
+static uint8_t pattern[ERASE_SECTOR_SIZE];
+static uint8_t read_buf[ERASE_SECTOR_SIZE];
+
+static void *update_suite_setup(void)
+{
+	int err;
+
+	for (int i = 0; i < ERASE_SECTOR_SIZE; i++) {
+		pattern[i] = (uint8_t)(i ^ 0x5A);
+	}
+
+	err = flash_erase(flash_dev, UPDATE_REGION_OFFSET, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash erase failed");
+
+	err = flash_write(flash_dev, UPDATE_REGION_OFFSET, pattern, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash write failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(flash_update_suite, NULL, update_suite_setup, NULL, NULL, NULL);
+
+ZTEST(flash_update_suite, test_update_paths)
+{
+	int err;
+	uint8_t data[UPDATE_LEN];
+	enum spi_flash_en25_update_path path;
+	off_t offset = UPDATE_REGION_OFFSET + 100;
+
+	/* Same data as already in flash */
+	err = spi_flash_en25_update(flash_dev, offset, &pattern[100], UPDATE_LEN, &path);
+	zassert_equal(err, 0, "Update failed");
+	zassert_equal(path, SPI_FLASH_EN25_UPDATE_UNCHANGED, "Unexpected path %d", path);
+
+	/* Only clearing bits, must not need an erase */
+	for (int i = 0; i < UPDATE_LEN; i++) {
+		data[i] = pattern[100 + i] & 0x0F;
+	}
+	err = spi_flash_en25_update(flash_dev, offset, data, UPDATE_LEN, &path);
+	zassert_equal(err, 0, "Update failed");
+	zassert_equal(path, SPI_FLASH_EN25_UPDATE_IN_PLACE, "Unexpected path %d", path);
+	memcpy(&pattern[100], data, UPDATE_LEN);
+
+	/* Setting bits requires the sector to be erased and rewritten */
+	for (int i = 0; i < UPDATE_LEN; i++) {
+		data[i] = 0xF0 | i;
+	}
+	err = spi_flash_en25_update(flash_dev, offset, data, UPDATE_LEN, &path);
+	zassert_equal(err, 0, "Update failed");
+	zassert_equal(path, SPI_FLASH_EN25_UPDATE_ERASED, "Unexpected path %d", path);
+	memcpy(&pattern[100], data, UPDATE_LEN);
+
+	/* The rest of the sector must be preserved in every case */
+	err = flash_read(flash_dev, UPDATE_REGION_OFFSET, read_buf, ERASE_SECTOR_SIZE);
+	zassert_equal(err, 0, "Flash read failed");
+	zassert_mem_equal(read_buf, pattern, ERASE_SECTOR_SIZE, "Sector contents differ");
+}